@@ -0,0 +1,337 @@
+#include "epoll_server.h"
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+bool reactorFromEnv() {
+    const char* v = std::getenv("HTTP_REACTOR");
+    return v && (std::string(v) == "1" || std::string(v) == "true");
+}
+}
+
+#ifndef __linux__
+std::unique_ptr<httplib::Server> createServer(const ServerConfig& cfg) {
+    if (reactorFromEnv()) {
+        std::cerr << "HTTP_REACTOR solo está disponible en Linux; se usa el modo normal." << std::endl;
+    }
+    auto svr = std::make_unique<httplib::Server>();
+    applyServerConfig(*svr, cfg);
+    return svr;
+}
+#else
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <vector>
+
+std::unique_ptr<httplib::Server> createServer(const ServerConfig& cfg) {
+    if (reactorFromEnv()) return std::make_unique<EpollServer>(cfg);
+    auto svr = std::make_unique<httplib::Server>();
+    applyServerConfig(*svr, cfg);
+    return svr;
+}
+
+namespace {
+// Ejecuta la tarea en el hilo que acepta: aparcar un socket es inmediato
+class InlineTaskQueue final : public httplib::TaskQueue {
+public:
+    bool enqueue(std::function<void()> fn) override { fn(); return true; }
+    void shutdown() override {}
+};
+
+// Stream sobre el socket que entrega primero los bytes ya leídos por el
+// reactor. cpp-httplib lee las líneas de byte en byte y el cuerpo con el
+// tamaño exacto, así que nunca consume bytes de la petición siguiente.
+class BufferedSocketStream final : public httplib::Stream {
+public:
+    BufferedSocketStream(socket_t sock, std::string& buffer, time_t readSec, time_t writeSec,
+                         const std::string& remoteAddr, int remotePort,
+                         const std::string& localAddr, int localPort)
+        : sock_(sock), buffer_(buffer), readSec_(readSec), writeSec_(writeSec),
+          remoteAddr_(remoteAddr), localAddr_(localAddr),
+          remotePort_(remotePort), localPort_(localPort),
+          start_(std::chrono::steady_clock::now()) {}
+
+    size_t consumed() const { return offset_; }
+
+    bool is_readable() const override { return offset_ < buffer_.size(); }
+    bool wait_readable() const override {
+        return is_readable() || httplib::detail::select_read(sock_, readSec_, 0) > 0;
+    }
+    // Como en cpp-httplib, pero sin is_socket_alive(): un FIN pendiente no
+    // impide responder, porque el cliente pudo cerrar solo su lado de
+    // escritura (half-close). Solo un error del socket corta la respuesta.
+    bool wait_writable() const override {
+        if (httplib::detail::select_write(sock_, writeSec_, 0) <= 0) return false;
+        char b;
+        ssize_t n = ::recv(sock_, &b, 1, MSG_PEEK | MSG_DONTWAIT);
+        return n >= 0 || errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+    }
+
+    ssize_t read(char* ptr, size_t size) override {
+        if (offset_ < buffer_.size()) {
+            size_t n = std::min(size, buffer_.size() - offset_);
+            std::memcpy(ptr, buffer_.data() + offset_, n);
+            offset_ += n;
+            return static_cast<ssize_t>(n);
+        }
+        if (!wait_readable()) return -1;
+        return httplib::detail::read_socket(sock_, ptr, size, CPPHTTPLIB_RECV_FLAGS);
+    }
+    ssize_t write(const char* ptr, size_t size) override {
+        if (!wait_writable()) return -1;
+        return httplib::detail::send_socket(sock_, ptr, size, CPPHTTPLIB_SEND_FLAGS);
+    }
+
+    void get_remote_ip_and_port(std::string& ip, int& port) const override {
+        ip = remoteAddr_;
+        port = remotePort_;
+    }
+    void get_local_ip_and_port(std::string& ip, int& port) const override {
+        ip = localAddr_;
+        port = localPort_;
+    }
+    socket_t socket() const override { return sock_; }
+    time_t duration() const override {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    socket_t sock_;
+    std::string& buffer_;
+    size_t offset_ = 0;
+    time_t readSec_, writeSec_;
+    const std::string& remoteAddr_;
+    const std::string& localAddr_;
+    int remotePort_, localPort_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Valor de Content-Length en el bloque de cabeceras [0, end); 0 si no hay
+size_t contentLength(const std::string& buf, size_t end) {
+    static const char name[] = "\r\ncontent-length:";
+    const size_t len = sizeof(name) - 1;
+    for (size_t i = buf.find("\r\n"); i != std::string::npos && i + len <= end;
+         i = buf.find("\r\n", i + 2)) {
+        bool match = true;
+        for (size_t k = 0; k < len && match; ++k) {
+            match = std::tolower(static_cast<unsigned char>(buf[i + k])) == name[k];
+        }
+        if (!match) continue;
+        size_t p = i + len;
+        while (p < end && (buf[p] == ' ' || buf[p] == '\t')) ++p;
+        size_t v = 0;
+        while (p < end && buf[p] >= '0' && buf[p] <= '9') v = v * 10 + (buf[p++] - '0');
+        return v;
+    }
+    return 0;
+}
+
+// ¿Hay en el buffer una petición lista para procesar sin bloquear al hilo?
+// Las cabeceras demasiado largas o los cuerpos por encima del máximo se
+// entregan igualmente para que cpp-httplib responda el error que toque.
+bool requestReady(const std::string& buf, size_t payloadMax) {
+    size_t end = buf.find("\r\n\r\n");
+    if (end == std::string::npos) return buf.size() > CPPHTTPLIB_HEADER_MAX_LENGTH;
+    size_t body = contentLength(buf, end + 2);
+    if (body > payloadMax) return true;
+    return buf.size() - (end + 4) >= body;
+}
+}
+
+EpollServer::EpollServer(const ServerConfig& cfg) {
+    applyServerConfig(*this, cfg);
+    // El pool propio atiende peticiones completas; el de cpp-httplib solo
+    // aparcaría sockets, así que se sustituye por ejecución directa.
+    workers_ = std::make_unique<BoundedTaskQueue>(cfg.threads, cfg.queueMax);
+    new_task_queue = [] { return new InlineTaskQueue(); };
+
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+
+    reactor_ = std::thread([this] { reactorLoop(); });
+    std::cout << "HTTP: reactor epoll activo" << std::endl;
+}
+
+EpollServer::~EpollServer() {
+    stopReactor();
+}
+
+void EpollServer::stopReactor() {
+    if (stopping_.exchange(true)) return;
+    uint64_t one = 1;
+    ssize_t n = ::write(wakeFd_, &one, sizeof(one));
+    (void)n;
+    if (reactor_.joinable()) reactor_.join();
+    // Las peticiones en curso terminan y cierran su conexión (stopping_)
+    workers_->shutdown();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& [fd, c] : connections_) {
+        httplib::detail::shutdown_socket(c->sock);
+        httplib::detail::close_socket(c->sock);
+    }
+    connections_.clear();
+    parked_.store(0, std::memory_order_relaxed);
+    ::close(wakeFd_);
+    ::close(epollFd_);
+}
+
+bool EpollServer::process_and_close_socket(socket_t sock) {
+    auto c = std::make_shared<Connection>();
+    c->sock = sock;
+    c->lastActive = std::chrono::steady_clock::now();
+    httplib::detail::get_remote_ip_and_port(sock, c->remoteAddr, c->remotePort);
+    httplib::detail::get_local_ip_and_port(sock, c->localAddr, c->localPort);
+
+    if (stopping_.load()) {
+        httplib::detail::shutdown_socket(sock);
+        httplib::detail::close_socket(sock);
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections_[sock] = c;
+    }
+    parked_.fetch_add(1, std::memory_order_relaxed);
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    ev.data.fd = sock;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, sock, &ev) != 0) {
+        closeConnection(c);
+        return false;
+    }
+    return true;
+}
+
+void EpollServer::reactorLoop() {
+    std::vector<epoll_event> events(256);
+    auto lastSweep = std::chrono::steady_clock::now();
+    while (!stopping_.load()) {
+        int n = epoll_wait(epollFd_, events.data(), static_cast<int>(events.size()), 1000);
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd_) continue;
+            ConnPtr c;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto it = connections_.find(fd);
+                if (it != connections_.end()) c = it->second;
+            }
+            if (c) onReadable(c);
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastSweep >= std::chrono::seconds(1)) {
+            closeIdle();
+            lastSweep = now;
+        }
+    }
+}
+
+void EpollServer::onReadable(const ConnPtr& c) {
+    char buf[4096];
+    for (;;) {
+        ssize_t n = ::recv(c->sock, buf, sizeof(buf), MSG_DONTWAIT);
+        if (n > 0) {
+            c->buffer.append(buf, static_cast<size_t>(n));
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0 && errno == EINTR) continue;
+        if (n == 0) {
+            // Half-close: no llegará nada más, pero lo ya recibido se atiende
+            c->peerClosed = true;
+            break;
+        }
+        closeConnection(c); // error en la conexión
+        return;
+    }
+    c->lastActive = std::chrono::steady_clock::now();
+    if (requestReady(c->buffer, payload_max_length_)) {
+        dispatch(c);
+    } else if (c->peerClosed) {
+        closeConnection(c); // petición incompleta que ya no puede terminar
+    } else {
+        rearm(c);
+    }
+}
+
+void EpollServer::dispatch(const ConnPtr& c) {
+    c->busy = true;
+    parked_.fetch_sub(1, std::memory_order_relaxed);
+    if (!workers_->enqueue([this, c] { serve(c); })) {
+        closeConnection(c); // cola llena: mismo descarte que cpp-httplib
+    }
+}
+
+void EpollServer::serve(const ConnPtr& c) {
+    for (;;) {
+        bool closeAfter = ++c->served >= keep_alive_max_count_ || stopping_.load();
+        bool closed = false;
+        BufferedSocketStream strm(c->sock, c->buffer, read_timeout_sec_, write_timeout_sec_,
+                                  c->remoteAddr, c->remotePort, c->localAddr, c->localPort);
+        bool ok = process_request(strm, c->remoteAddr, c->remotePort, c->localAddr,
+                                  c->localPort, closeAfter, closed, nullptr);
+        c->buffer.erase(0, strm.consumed());
+
+        if (!ok || closed || closeAfter) {
+            closeConnection(c);
+            return;
+        }
+        c->lastActive = std::chrono::steady_clock::now();
+        // Peticiones encadenadas (pipelining) ya recibidas: seguir aquí
+        if (!requestReady(c->buffer, payload_max_length_)) {
+            if (c->peerClosed) {
+                closeConnection(c);
+                return;
+            }
+            break;
+        }
+    }
+    c->busy = false;
+    parked_.fetch_add(1, std::memory_order_relaxed);
+    rearm(c);
+}
+
+void EpollServer::rearm(const ConnPtr& c) {
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+    ev.data.fd = c->sock;
+    if (epoll_ctl(epollFd_, EPOLL_CTL_MOD, c->sock, &ev) != 0) closeConnection(c);
+}
+
+void EpollServer::closeConnection(const ConnPtr& c) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = connections_.find(c->sock);
+        if (it == connections_.end() || it->second != c) return;
+        connections_.erase(it);
+    }
+    if (!c->busy) parked_.fetch_sub(1, std::memory_order_relaxed);
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, c->sock, nullptr);
+    httplib::detail::shutdown_socket(c->sock);
+    httplib::detail::close_socket(c->sock);
+}
+
+// Cierra las conexiones aparcadas más tiempo que el keep-alive configurado
+void EpollServer::closeIdle() {
+    auto limit = std::chrono::steady_clock::now() - std::chrono::seconds(keep_alive_timeout_sec_);
+    std::vector<ConnPtr> idle;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& [fd, c] : connections_) {
+            if (!c->busy && c->lastActive < limit) idle.push_back(c);
+        }
+    }
+    for (auto& c : idle) closeConnection(c);
+}
+#endif
@@ -0,0 +1,75 @@
+#ifndef EPOLL_SERVER_H
+#define EPOLL_SERVER_H
+
+#include "httplib.h"
+#include "server_bootstrap.h"
+#include <memory>
+
+// Crea el servidor HTTP ya configurado. Con HTTP_REACTOR=1 (solo Linux)
+// devuelve un EpollServer; si no, un httplib::Server normal.
+std::unique_ptr<httplib::Server> createServer(const ServerConfig& cfg);
+
+#ifdef __linux__
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// --- SERVIDOR CON REACTOR EPOLL ---
+// cpp-httplib deja un hilo del pool bloqueado en cada conexión keep-alive
+// hasta que llega la siguiente petición o vence el timeout. Aquí las
+// conexiones inactivas se aparcan en un epoll y un hilo reactor acumula sus
+// bytes; solo cuando hay una petición completa (cabeceras y cuerpo según
+// Content-Length) se entrega a un hilo del pool, que la procesa con el
+// mismo process_request de cpp-httplib. Los handlers no cambian.
+class EpollServer final : public httplib::Server {
+public:
+    explicit EpollServer(const ServerConfig& cfg);
+    ~EpollServer() override;
+
+    size_t parked() const { return parked_.load(std::memory_order_relaxed); }
+    size_t open() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return connections_.size();
+    }
+
+private:
+    struct Connection {
+        socket_t sock = INVALID_SOCKET;
+        std::string buffer;          // bytes recibidos aún no procesados
+        size_t served = 0;           // peticiones atendidas (keep-alive max)
+        std::atomic<bool> busy{false}; // en manos de un hilo del pool
+        bool peerClosed = false;     // el cliente cerró su lado de escritura
+        std::chrono::steady_clock::time_point lastActive;
+        std::string remoteAddr, localAddr;
+        int remotePort = 0, localPort = 0;
+    };
+    using ConnPtr = std::shared_ptr<Connection>;
+
+    // cpp-httplib la llama por cada socket aceptado: aquí solo se aparca
+    bool process_and_close_socket(socket_t sock) override;
+
+    void reactorLoop();
+    void onReadable(const ConnPtr& c);
+    void dispatch(const ConnPtr& c);
+    void serve(const ConnPtr& c);
+    void rearm(const ConnPtr& c);
+    void closeConnection(const ConnPtr& c);
+    void closeIdle();
+    void stopReactor();
+
+    int epollFd_ = -1;
+    int wakeFd_ = -1;
+    std::unique_ptr<BoundedTaskQueue> workers_;
+    std::thread reactor_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<size_t> parked_{0};
+
+    mutable std::mutex mutex_;
+    std::unordered_map<socket_t, ConnPtr> connections_;
+};
+#endif
+
+#endif // EPOLL_SERVER_H
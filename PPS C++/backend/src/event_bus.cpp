@@ -0,0 +1,173 @@
+#include "event_bus.h"
+#include "secure_random.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+void readEnv(const char* name, size_t& value) {
+    const char* v = std::getenv(name);
+    if (!v || !*v) return;
+    try {
+        value = static_cast<size_t>(std::stoull(v));
+    } catch (...) {
+        std::cerr << "Valor inválido para " << name << ": " << v << std::endl;
+    }
+}
+}
+
+EventBusConfig EventBusConfig::fromEnv(size_t httpThreads) {
+    EventBusConfig cfg;
+    readEnv("SSE_MAX_SUBSCRIBERS", cfg.maxSubscribers);
+    readEnv("SSE_QUEUE_LIMIT", cfg.queueLimit);
+    readEnv("SSE_HISTORY", cfg.history);
+    readEnv("SSE_RETENTION", cfg.retention);
+    readEnv("SSE_TICKET_TTL", cfg.ticketTtl);
+    // Cada flujo ocupa un hilo del pool mientras está abierto
+    if (cfg.maxSubscribers == 0) cfg.maxSubscribers = std::max<size_t>(1, httpThreads / 2);
+    if (cfg.queueLimit == 0) cfg.queueLimit = 1;
+    if (cfg.ticketTtl == 0) cfg.ticketTtl = 1;
+    return cfg;
+}
+
+bool MarathonEventBus::Subscription::wait(std::vector<Frame>& out, std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait_for(lock, timeout, [&] { return closed_ || !queue_.empty(); });
+    out.assign(queue_.begin(), queue_.end());
+    queue_.clear();
+    // Lo ya encolado se entrega aunque el flujo se haya cerrado
+    return !closed_ || !out.empty();
+}
+
+void MarathonEventBus::Subscription::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    cond_.notify_all();
+}
+
+bool MarathonEventBus::Subscription::push(const Frame& frame, size_t limit) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (closed_) return false;
+        if (queue_.size() >= limit) {
+            // Cliente lento: se corta y recupera con Last-Event-ID
+            closed_ = true;
+            queue_.clear();
+        } else {
+            queue_.push_back(frame);
+        }
+    }
+    cond_.notify_all();
+    return true;
+}
+
+MarathonEventBus::MarathonEventBus(const EventBusConfig& cfg) : cfg_(cfg) {}
+
+bool MarathonEventBus::expired(const Topic& topic, std::chrono::steady_clock::time_point now) const {
+    return topic.subs.empty() && now - topic.idleSince >= std::chrono::seconds(cfg_.retention);
+}
+
+MarathonEventBus::SubscriptionPtr MarathonEventBus::subscribe(int64_t marathonId, uint64_t lastEventId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (subscribers_ >= cfg_.maxSubscribers) return nullptr;
+
+    auto sub = std::make_shared<Subscription>();
+    Topic& topic = topics_[marathonId];
+    if (lastEventId > 0) {
+        for (const auto& [id, frame] : topic.history) {
+            if (id > lastEventId) sub->queue_.push_back(frame);
+        }
+    }
+    topic.subs.push_back(sub);
+    ++subscribers_;
+    return sub;
+}
+
+void MarathonEventBus::unsubscribe(int64_t marathonId, const SubscriptionPtr& sub) {
+    sub->close();
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = topics_.find(marathonId);
+    if (it == topics_.end()) return;
+    auto& subs = it->second.subs;
+    auto pos = std::find(subs.begin(), subs.end(), sub);
+    if (pos == subs.end()) return;
+    subs.erase(pos);
+    --subscribers_;
+    if (!subs.empty()) return;
+
+    // Se conserva el historial por si reconecta; los temas vencidos se borran
+    auto now = std::chrono::steady_clock::now();
+    it->second.idleSince = now;
+    for (auto t = topics_.begin(); t != topics_.end();) {
+        t = expired(t->second, now) ? topics_.erase(t) : std::next(t);
+    }
+}
+
+uint64_t MarathonEventBus::publish(int64_t marathonId, const std::string& event, const std::string& data) {
+    std::vector<SubscriptionPtr> subs;
+    Frame frame;
+    uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = nextId_++;
+        // Sin clientes recientes no hay a quién entregarlo ni quién lo pida
+        auto it = topics_.find(marathonId);
+        if (it == topics_.end()) return id;
+        if (expired(it->second, std::chrono::steady_clock::now())) {
+            topics_.erase(it);
+            return id;
+        }
+        frame = std::make_shared<const std::string>(
+            "id: " + std::to_string(id) + "\nevent: " + event + "\ndata: " + data + "\n\n");
+        Topic& topic = it->second;
+        topic.history.emplace_back(id, frame);
+        while (topic.history.size() > cfg_.history) topic.history.pop_front();
+        subs = topic.subs;
+    }
+    // El reparto se hace fuera del mutex del bus
+    for (const auto& sub : subs) sub->push(frame, cfg_.queueLimit);
+    return id;
+}
+
+void MarathonEventBus::closeTopic(int64_t marathonId) {
+    std::vector<SubscriptionPtr> subs;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = topics_.find(marathonId);
+        if (it == topics_.end()) return;
+        subs = std::move(it->second.subs);
+        subscribers_ -= subs.size();
+        topics_.erase(it);
+    }
+    for (const auto& sub : subs) sub->close();
+}
+
+size_t MarathonEventBus::subscribers() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return subscribers_;
+}
+
+StreamTickets::StreamTickets(std::chrono::seconds ttl) : ttl_(ttl) {}
+
+std::string StreamTickets::issue(int64_t marathonId, int userId) {
+    std::string ticket = SecureRandom::token(24);
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = tickets_.begin(); it != tickets_.end();) {
+        it = it->second.expires <= now ? tickets_.erase(it) : std::next(it);
+    }
+    tickets_[ticket] = {marathonId, userId, now + ttl_};
+    return ticket;
+}
+
+std::optional<int> StreamTickets::redeem(const std::string& ticket, int64_t marathonId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = tickets_.find(ticket);
+    if (it == tickets_.end()) return std::nullopt;
+    Entry e = it->second;
+    tickets_.erase(it);
+    if (e.marathonId != marathonId || e.expires <= std::chrono::steady_clock::now()) return std::nullopt;
+    return e.userId;
+}
@@ -0,0 +1,110 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// --- CONFIGURACIÓN DEL BUS ---
+struct EventBusConfig {
+    size_t maxSubscribers = 0;   // SSE_MAX_SUBSCRIBERS (0 = mitad de los hilos HTTP)
+    size_t queueLimit     = 64;  // SSE_QUEUE_LIMIT: eventos pendientes por cliente
+    size_t history        = 32;  // SSE_HISTORY: eventos guardados por maratón (Last-Event-ID)
+    size_t retention      = 60;  // SSE_RETENTION: segundos que se guarda el historial sin clientes
+    size_t ticketTtl      = 30;  // SSE_TICKET_TTL: segundos de validez de un ticket de flujo
+
+    static EventBusConfig fromEnv(size_t httpThreads);
+};
+
+// --- BUS DE EVENTOS POR MARATÓN ---
+// Pub/sub en memoria. Cada evento se serializa una sola vez como trama SSE
+// y la misma cadena inmutable se comparte entre todos los suscriptores.
+// Un cliente que acumula más de queueLimit eventos se desconecta; al
+// reconectar con Last-Event-ID recupera lo que siga en el historial.
+// Solo se guarda historial de maratones con clientes o que los tuvieron
+// hace menos de `retention` segundos; pasado ese plazo el tema se borra.
+class MarathonEventBus {
+public:
+    using Frame = std::shared_ptr<const std::string>;
+
+    class Subscription {
+    public:
+        // Espera eventos hasta el timeout. Devuelve false si se cerró.
+        bool wait(std::vector<Frame>& out, std::chrono::milliseconds timeout);
+        void close();
+
+    private:
+        friend class MarathonEventBus;
+        bool push(const Frame& frame, size_t limit);
+
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        std::deque<Frame> queue_;
+        bool closed_ = false;
+    };
+    using SubscriptionPtr = std::shared_ptr<Subscription>;
+
+    explicit MarathonEventBus(const EventBusConfig& cfg);
+
+    // nullptr si se alcanzó el máximo de suscriptores. Los eventos con id
+    // mayor que lastEventId que sigan en el historial se entregan primero.
+    SubscriptionPtr subscribe(int64_t marathonId, uint64_t lastEventId = 0);
+    void unsubscribe(int64_t marathonId, const SubscriptionPtr& sub);
+
+    // `data` es JSON ya serializado. Devuelve el id del evento.
+    uint64_t publish(int64_t marathonId, const std::string& event, const std::string& data);
+    // Cierra los flujos de la maratón (tras borrarla) y olvida su historial
+    void closeTopic(int64_t marathonId);
+
+    size_t subscribers() const;
+
+private:
+    struct Topic {
+        std::vector<SubscriptionPtr> subs;
+        std::deque<std::pair<uint64_t, Frame>> history;
+        std::chrono::steady_clock::time_point idleSince; // sin clientes desde
+    };
+
+    bool expired(const Topic& topic, std::chrono::steady_clock::time_point now) const;
+
+    EventBusConfig cfg_;
+    mutable std::mutex mutex_;
+    std::unordered_map<int64_t, Topic> topics_;
+    size_t subscribers_ = 0;
+    uint64_t nextId_ = 1;
+};
+
+// --- TICKETS DE FLUJO ---
+// EventSource no puede enviar cabeceras. Para no poner el JWT en la URL
+// (logs, historial), el cliente pide con su token un ticket para una
+// maratón y lo pasa en ?ticket=. El ticket sirve una sola vez y caduca a
+// los ticketTtl segundos; al reconectar se pide otro.
+class StreamTickets {
+public:
+    explicit StreamTickets(std::chrono::seconds ttl);
+
+    std::string issue(int64_t marathonId, int userId);
+    // Consume el ticket; devuelve el usuario si era válido para esa maratón
+    std::optional<int> redeem(const std::string& ticket, int64_t marathonId);
+
+private:
+    struct Entry {
+        int64_t marathonId;
+        int userId;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    std::chrono::seconds ttl_;
+    std::mutex mutex_;
+    std::unordered_map<std::string, Entry> tickets_;
+};
+
+#endif // EVENT_BUS_H
@@ -1,20 +1,52 @@
 #include <iostream>
 #include <string>
 #include <vector>
-#include <random>
 #include <chrono>
+#include <memory>
 #include <cstring>
 #include "httplib.h"
 #include "json.hpp"
 #include "libpq-fe.h"
+#include "pg_pool.h"
 #include "jwt-cpp/jwt.h"
 #include <argon2.h>
+#include "query_batch.h"
+#include "row_decoder.h"
+#include "secure_random.h"
+#include "server_bootstrap.h"
+#include "epoll_server.h"
+#include "event_bus.h"
+#include "response_compression.h"
+#include "trie_router.h"
+#include "metrics.h"
 
 using json = nlohmann::json;
 
 // --- CONFIGURACIÓN ---
 const char* CONN_STRING = "dbname=programming_contest_db user=postgres password=btsyjulian host=localhost port=5432";
 const std::string JWT_SECRET = "una_clave_muy_secreta_y_larga_que_nadie_deberia_adivinar_facilmente";
+const size_t BATCH_MAX_REQUESTS = 20;   // sub-peticiones por llamada a /api/batch
+
+// --- FASES MEDIDAS (ver metrics.h) ---
+const metrics::SeriesId PHASE_AUTH      = metrics::phase("auth");
+const metrics::SeriesId PHASE_DB        = metrics::phase("db");
+const metrics::SeriesId PHASE_HASH      = metrics::phase("hash");
+const metrics::SeriesId PHASE_SERIALIZE = metrics::phase("serialize");
+
+// PQexecParams con la fase "db" medida
+PGresult* timedExecParams(PGconn* conn, const char* command, int nParams, const Oid* paramTypes,
+                          const char* const* paramValues, const int* paramLengths,
+                          const int* paramFormats, int resultFormat) {
+    metrics::ScopedTimer timer(PHASE_DB);
+    return PQexecParams(conn, command, nParams, paramTypes, paramValues, paramLengths,
+                        paramFormats, resultFormat);
+}
+
+// Respuestas grandes (listados): la serialización se mide aparte
+std::string dumpTimed(const json& j) {
+    metrics::ScopedTimer timer(PHASE_SERIALIZE);
+    return j.dump();
+}
 
 // --- ESTRUCTURA DE USUARIO AUTENTICADO ---
 struct AuthUser {
@@ -24,13 +56,74 @@ struct AuthUser {
     int userId = -1;
 };
 
-// --- VERIFICACIÓN DE TOKEN JWT ---
-AuthUser verifyTokenAndGetUser(const httplib::Request& req) {
-    if (!req.has_header("Authorization")) return {};
-    std::string auth_header = req.get_header_value("Authorization");
-    if (auth_header.rfind("Bearer ", 0) != 0) return {};
-    std::string token_str = auth_header.substr(7);
+// --- FILAS TIPADAS (resultados binarios, ver row_decoder.h) ---
+namespace pgrow {
+inline void to_json(json& j, const Timestamp& t) { j = t.str(); }
+}
+
+struct MarathonRow {
+    int id = 0;
+    std::string name;
+    std::string description;
+    pgrow::Timestamp created_at;
+    std::string created_by;
+    int max_problems = 0;
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_ONLY_SERIALIZE(MarathonRow, id, name, description, created_at, created_by, max_problems)
+using MarathonColumns = pgrow::Columns<&MarathonRow::id, &MarathonRow::name, &MarathonRow::description,
+                                       &MarathonRow::created_at, &MarathonRow::created_by, &MarathonRow::max_problems>;
+
+struct ProblemRow {
+    int id = 0;
+    std::string title;
+    std::string description;
+    std::string difficulty;
+    pgrow::Timestamp created_at;
+    std::string created_by;
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_ONLY_SERIALIZE(ProblemRow, id, title, description, difficulty, created_at, created_by)
+using ProblemColumns = pgrow::Columns<&ProblemRow::id, &ProblemRow::title, &ProblemRow::description,
+                                      &ProblemRow::difficulty, &ProblemRow::created_at, &ProblemRow::created_by>;
+
+struct AssignedProblemRow {
+    int id = 0;
+    std::string title;
+    std::string description;
+    std::string difficulty;
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_ONLY_SERIALIZE(AssignedProblemRow, id, title, description, difficulty)
+using AssignedProblemColumns = pgrow::Columns<&AssignedProblemRow::id, &AssignedProblemRow::title,
+                                              &AssignedProblemRow::description, &AssignedProblemRow::difficulty>;
+
+struct StudentRow {
+    int id = 0;
+    std::string username;
+    pgrow::Timestamp registered_at;
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_ONLY_SERIALIZE(StudentRow, id, username, registered_at)
+using StudentColumns = pgrow::Columns<&StudentRow::id, &StudentRow::username, &StudentRow::registered_at>;
+
+struct RegistrationRow {
+    int id = 0;
+    std::string name;
+    std::string description;
+    pgrow::Timestamp registered_at;
+};
+NLOHMANN_DEFINE_TYPE_NON_INTRUSIVE_ONLY_SERIALIZE(RegistrationRow, id, name, description, registered_at)
+using RegistrationColumns = pgrow::Columns<&RegistrationRow::id, &RegistrationRow::name,
+                                           &RegistrationRow::description, &RegistrationRow::registered_at>;
+
+struct UserRow {
+    int id = 0;
+    std::string username;
+    std::string role;
+    pgrow::Timestamp created_at;
+};
+using UserColumns = pgrow::Columns<&UserRow::id, &UserRow::username, &UserRow::role, &UserRow::created_at>;
 
+// --- VERIFICACIÓN DE TOKEN JWT ---
+AuthUser verifyToken(const std::string& token_str) {
+    metrics::ScopedTimer timer(PHASE_AUTH);
     try {
         auto decoded = jwt::decode(token_str);
         jwt::verify()
@@ -49,13 +142,33 @@ AuthUser verifyTokenAndGetUser(const httplib::Request& req) {
     }
 }
 
+// Sub-petición de /api/batch en curso en este hilo: su token ya se verificó
+// una vez para todo el lote.
+thread_local const httplib::Request* batchRequest = nullptr;
+thread_local AuthUser batchUser;
+
+AuthUser verifyTokenAndGetUser(const httplib::Request& req) {
+    if (&req == batchRequest) return batchUser;
+    if (!req.has_header("Authorization")) return {};
+    std::string auth_header = req.get_header_value("Authorization");
+    if (auth_header.rfind("Bearer ", 0) != 0) return {};
+    return verifyToken(auth_header.substr(7));
+}
+
+// Rutas que responden con un flujo (SSE) y no caben en /api/batch. Se
+// comprueban antes de llamar al handler, que ya canjearía el ticket,
+// consultaría la base y ocuparía una plaza de suscriptor. Solo se usa tras
+// router.match: la única ruta GET que acaba en /events es el flujo.
+bool isStreamingRoute(const std::string& method, const std::string& path) {
+    static const std::string suffix = "/events";
+    return method == "GET" && path.size() >= suffix.size() &&
+           path.compare(path.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
 // --- ARGON2 HASHING ---
 std::string hash_password(const std::string& password) {
-    std::vector<uint8_t> salt(16);
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<uint8_t> dis(0, 255);
-    for (auto& b : salt) b = dis(gen);
+    metrics::ScopedTimer timer(PHASE_HASH);
+    std::vector<uint8_t> salt = SecureRandom::salt(16);
 
     uint32_t t_cost      = 2;
     uint32_t m_cost      = (1 << 16);
@@ -80,33 +193,113 @@ std::string hash_password(const std::string& password) {
 }
 
 bool verify_password(const std::string& password, const std::string& hash) {
+    metrics::ScopedTimer timer(PHASE_HASH);
     return argon2id_verify(hash.c_str(), password.c_str(), password.size()) == ARGON2_OK;
 }
 
+// --- ASIGNACIÓN DE PROBLEMAS A MARATÓN ---
+// Bloquea la fila de la maratón y luego inserta los problemas solo si caben
+// en max_problems. Ambas sentencias viajan juntas en el mismo lote (una sola
+// transacción). `conn` debe ser la conexión prestada a esta petición
+// (PgPool): solo entre sesiones distintas el FOR UPDATE hace esperar al
+// segundo profesor hasta que el primero confirma, y así ninguno de los dos
+// puede superar el límite.
+struct AssignResult {
+    int status;
+    std::string message;
+    int assigned = 0;
+};
+
+AssignResult assignProblems(PGconn* conn, const std::string& mid, const std::vector<int>& pids) {
+    if (pids.empty()) return {400, "Sin problemas"};
+
+    std::string ids = "{";
+    for (size_t i = 0; i < pids.size(); ++i) {
+        if (i) ids += ",";
+        ids += std::to_string(pids[i]);
+    }
+    ids += "}";
+
+    QueryBatch batch(conn);
+    batch.add("SELECT id FROM marathons WHERE id=$1 FOR UPDATE", {mid});
+    batch.add(
+        "INSERT INTO marathon_problems (problem_id,marathon_id) "
+        "SELECT t.pid, m.id FROM marathons m, unnest($2::int[]) AS t(pid) "
+        "WHERE m.id=$1 AND (SELECT COUNT(*) FROM marathon_problems WHERE marathon_id=$1) "
+        "+ cardinality($2::int[]) <= m.max_problems "
+        "RETURNING problem_id",
+        {mid, ids});
+    batch.run();
+
+    if (!batch.ok(0)) return {500, "Error al asignar"};
+    if (PQntuples(batch.result(0)) != 1) return {404, "Maratón no encontrada"};
+    if (!batch.ok(1)) {
+        const char* state = PQresultErrorField(batch.result(1), PG_DIAG_SQLSTATE);
+        std::string code = state ? state : "";
+        if (code == "23505") return {409, "Problema ya asignado"};
+        if (code == "23503") return {404, "Problema no encontrado"};
+        return {500, "Error al asignar"};
+    }
+    int n = PQntuples(batch.result(1));
+    if (n == 0) return {400, "Límite alcanzado"};
+    return {201, pids.size() == 1 ? "Problema asignado" : "Problemas asignados", n};
+}
+
 int main() {
-    // Conexión a PostgreSQL
-    PGconn* conn = PQconnectdb(CONN_STRING);
-    if (PQstatus(conn) != CONNECTION_OK) {
-        std::cerr << "Error de conexión: " << PQerrorMessage(conn) << std::endl;
+    // Hilos, cola, keep-alive, backlog y listeners (variables de entorno
+    // HTTP_*); con HTTP_REACTOR=1 las conexiones inactivas esperan en epoll
+    ServerConfig http = ServerConfig::fromEnv();
+
+    // Conexiones a PostgreSQL: una por petición en curso (PG_POOL_*)
+    std::unique_ptr<PgPool> pool;
+    try {
+        pool = std::make_unique<PgPool>(CONN_STRING, PgPool::sizeFromEnv(http.threads), PgPool::timeoutFromEnv());
+    } catch (const std::exception& e) {
+        std::cerr << "Error de conexión: " << e.what() << std::endl;
         return 1;
     }
-    std::cout << "Conexión a PostgreSQL exitosa." << std::endl;
+    PgPool& db = *pool;
+    std::cout << "Conexión a PostgreSQL exitosa (" << db.size() << " conexiones)." << std::endl;
+
+    ListenerGroup servers(http, createServer);
+    // gzip negociado para respuestas grandes (variables HTTP_COMPRESSION_*)
+    ResponseCompressor compressor(CompressionConfig::fromEnv());
 
-    httplib::Server svr;
+    // Rutas en un trie radix; se conectan al servidor antes de escuchar
+    TrieRouter router;
+
+    // Cambios de cada maratón para los clientes SSE (variables SSE_*)
+    EventBusConfig eventsCfg = EventBusConfig::fromEnv(http.threads);
+    MarathonEventBus events(eventsCfg);
+    StreamTickets streamTickets(std::chrono::seconds(eventsCfg.ticketTtl));
 
     // --- CORS (único punto) ---
-    svr.set_pre_routing_handler([](const auto& /*req*/, auto& res) {
+    auto cors = [](const httplib::Request& /*req*/, httplib::Response& res) {
         res.set_header("Access-Control-Allow-Origin",  "*");
         res.set_header("Access-Control-Allow-Headers", "Content-Type, Authorization");
         res.set_header("Access-Control-Allow-Methods", "GET, POST, PUT, DELETE, OPTIONS");
-        return httplib::Server::HandlerResponse::Unhandled;
-    });
-    svr.Options(R"((.*))", [](const auto& /*req*/, auto& res) {
-        res.status = 204;
+    };
+    servers.each([](httplib::Server& svr) {
+        svr.Options(R"((.*))", [](const auto& /*req*/, auto& res) {
+            res.status = 204;
+        });
+        // Sin conexión libre a tiempo: 503 para que el cliente reintente
+        svr.set_exception_handler([](const auto& /*req*/, auto& res, std::exception_ptr ep) {
+            res.set_header("Content-Type","application/json");
+            try {
+                std::rethrow_exception(ep);
+            } catch (const PgPool::Timeout& e) {
+                res.status = 503;
+                res.set_content(json{{"success",false},{"message",e.what()}}.dump(),"application/json");
+            } catch (...) {
+                res.status = 500;
+                res.set_content(json{{"success",false},{"message","Error interno"}}.dump(),"application/json");
+            }
+        });
     });
 
     // --- ENDPOINT: Registro ---
-    svr.Post("/api/register", [&](const auto& req, auto& res) {
+    router.Post("/api/register", [&](const auto& req, auto& res) {
         res.set_header("Content-Type", "application/json");
         try {
             json body = json::parse(req.body);
@@ -121,7 +314,8 @@ int main() {
             }
             std::string pwd_hash = hash_password(password);
             const char* params[3] = { username.c_str(), pwd_hash.c_str(), role.c_str() };
-            PGresult* r = PQexecParams(conn,
+            auto conn = db.acquire();
+            PGresult* r = timedExecParams(conn,
                 "INSERT INTO users (username,password_hash,role) VALUES($1,$2,$3)",
                 3, NULL, params, NULL, NULL, 0);
             if (PQresultStatus(r) != PGRES_COMMAND_OK) {
@@ -138,6 +332,9 @@ int main() {
                 res.set_content(json{{"success",true},{"message","Usuario registrado"}}.dump(),"application/json");
             }
             PQclear(r);
+        } catch (const PgPool::Timeout& e) {
+            res.status = 503;
+            res.set_content(json{{"success",false},{"message",e.what()}}.dump(),"application/json");
         } catch (...) {
             res.status = 400;
             res.set_content(json{{"success",false},{"message","Datos inválidos"}}.dump(),"application/json");
@@ -145,15 +342,16 @@ int main() {
     });
 
     // --- ENDPOINT: Login ---
-    svr.Post("/api/login", [&](const auto& req, auto& res) {
+    router.Post("/api/login", [&](const auto& req, auto& res) {
         res.set_header("Content-Type", "application/json");
         try {
             json body = json::parse(req.body);
             std::string username = body.at("username");
             std::string password = body.at("password");
 
+            auto conn = db.acquire();
             const char* p[1] = { username.c_str() };
-            PGresult* r = PQexecParams(conn,
+            PGresult* r = timedExecParams(conn,
                 "SELECT id,password_hash,role FROM users WHERE username=$1",
                 1, NULL, p, NULL, NULL, 0);
 
@@ -187,6 +385,9 @@ int main() {
                 res.set_content(json{{"success",false},{"message","Credenciales inválidas"}}.dump(),"application/json");
             }
             PQclear(r);
+        } catch (const PgPool::Timeout& e) {
+            res.status = 503;
+            res.set_content(json{{"success",false},{"message",e.what()}}.dump(),"application/json");
         } catch (...) {
             res.status = 400;
             res.set_content(json{{"success",false},{"message","Datos inválidos"}}.dump(),"application/json");
@@ -194,7 +395,7 @@ int main() {
     });
 
     // --- ENDPOINT: Obtener usuario actual ---
-    svr.Get("/api/me", [&](const auto& req, auto& res) {
+    router.Get("/api/me", [&](const auto& req, auto& res) {
         res.set_header("Content-Type","application/json");
         AuthUser u = verifyTokenAndGetUser(req);
         if (!u.isAuthenticated) {
@@ -215,7 +416,7 @@ int main() {
 
     // --- ENDPOINTS DE MARATONES ---
     // Crear maratón con límite de problemas
-    svr.Post("/api/marathons", [&](const auto& req, auto& res) {
+    router.Post("/api/marathons", [&](const auto& req, auto& res) {
         res.set_header("Content-Type","application/json");
         AuthUser u = verifyTokenAndGetUser(req);
         if (!u.isAuthenticated || (u.role!="admin" && u.role!="professor")) {
@@ -233,7 +434,8 @@ int main() {
               name.c_str(), desc.c_str(), uid.c_str(),
               std::to_string(maxp).c_str()
             };
-            PGresult* r = PQexecParams(conn,
+            auto conn = db.acquire();
+            PGresult* r = timedExecParams(conn,
               "INSERT INTO marathons (name,description,created_by,max_problems) "
               "VALUES($1,$2,$3,$4) RETURNING id",
               4, NULL, params, NULL, NULL, 0);
@@ -246,6 +448,9 @@ int main() {
                 res.set_content(json{{"success",false},{"message","Error al crear maratón"}}.dump(),"application/json");
             }
             PQclear(r);
+        } catch (const PgPool::Timeout& e) {
+            res.status = 503;
+            res.set_content(json{{"success",false},{"message",e.what()}}.dump(),"application/json");
         } catch (...) {
             res.status = 400;
             res.set_content(json{{"success",false},{"message","Datos inválidos"}}.dump(),"application/json");
@@ -253,7 +458,7 @@ int main() {
     });
 
     // Listar todas las maratones
-    svr.Get("/api/marathons", [&](const auto& req, auto& res) {
+    router.Get("/api/marathons", [&](const auto& req, auto& res) {
         res.set_header("Content-Type","application/json");
         AuthUser u = verifyTokenAndGetUser(req);
         if (!u.isAuthenticated) {
@@ -261,117 +466,187 @@ int main() {
             res.set_content(json{{"success",false},{"message","No autenticado"}}.dump(),"application/json");
             return;
         }
-        PGresult* r = PQexec(conn,
+        auto conn = db.acquire();
+        json arr = pgrow::fetchRows<MarathonColumns>(conn,
             "SELECT m.id,m.name,m.description,m.created_at,u.username,m.max_problems "
             "FROM marathons m JOIN users u ON m.created_by=u.id "
             "ORDER BY m.created_at DESC");
-        json arr = json::array();
-        for (int i=0;i<PQntuples(r);++i) {
-            arr.push_back({
-              {"id", std::stoi(PQgetvalue(r,i,0))},
-              {"name", PQgetvalue(r,i,1)},
-              {"description", PQgetvalue(r,i,2)},
-              {"created_at", PQgetvalue(r,i,3)},
-              {"created_by", PQgetvalue(r,i,4)},
-              {"max_problems", std::stoi(PQgetvalue(r,i,5))}
-            });
-        }
-        PQclear(r);
         res.status = 200;
-        res.set_content(json{{"success",true},{"marathons",arr}}.dump(),"application/json");
+        res.set_content(dumpTimed(json{{"success",true},{"marathons",arr}}),"application/json");
     });
 
     // Detalle de maratón + problemas asignados
-    svr.Get(R"(/api/marathons/(\d+))", [&](const auto& req, auto& res) {
+    router.Get("/api/marathons/{int}", [&](const auto& req, auto& res, const RouteParams& ruta) {
         res.set_header("Content-Type","application/json");
         AuthUser u = verifyTokenAndGetUser(req);
         if (!u.isAuthenticated) {
             res.status = 401; res.set_content(json{{"success",false},{"message","No autenticado"}}.dump(),"application/json");
             return;
         }
-        std::string mid = req.matches[1];
-        const char* p_mid[1] = { mid.c_str() };
+        std::string mid = ruta.text(0);
 
-        // Datos de la maratón
-        PGresult* r1 = PQexecParams(conn,
+        // Datos de la maratón y problemas asignados en un solo viaje
+        auto conn = db.acquire();
+        QueryBatch batch(conn);
+        batch.add(
             "SELECT m.id,m.name,m.description,m.created_at,u.username,m.max_problems "
             "FROM marathons m JOIN users u ON m.created_by=u.id WHERE m.id=$1",
-            1,NULL,p_mid,NULL,NULL,0);
-        if (PQntuples(r1)!=1) {
-            res.status = 404; res.set_content(json{{"success",false},{"message","No encontrada"}}.dump(),"application/json");
-            PQclear(r1); return;
-        }
-        json m = {
-          {"id", std::stoi(PQgetvalue(r1,0,0))},
-          {"name", PQgetvalue(r1,0,1)},
-          {"description", PQgetvalue(r1,0,2)},
-          {"created_at", PQgetvalue(r1,0,3)},
-          {"created_by", PQgetvalue(r1,0,4)},
-          {"max_problems", std::stoi(PQgetvalue(r1,0,5))}
-        };
-        PQclear(r1);
-
-        // Problemas asignados
-        PGresult* r2 = PQexecParams(conn,
+            {mid}, true);
+        batch.add(
             "SELECT p.id,p.title,p.description,p.difficulty "
             "FROM problems p JOIN marathon_problems mp ON p.id=mp.problem_id "
             "WHERE mp.marathon_id=$1",
-            1,NULL,p_mid,NULL,NULL,0);
-        json arr = json::array();
-        for (int i=0;i<PQntuples(r2);++i) {
-            arr.push_back({
-              {"id", std::stoi(PQgetvalue(r2,i,0))},
-              {"title", PQgetvalue(r2,i,1)},
-              {"description", PQgetvalue(r2,i,2)},
-              {"difficulty", PQgetvalue(r2,i,3)}
-            });
-        }
-        PQclear(r2);
+            {mid}, true);
+        batch.run();
+        auto marathons = pgrow::decodeRows<MarathonColumns>(batch.result(0));
+        if (marathons.size()!=1) {
+            res.status = 404; res.set_content(json{{"success",false},{"message","No encontrada"}}.dump(),"application/json");
+            return;
+        }
+        json m = marathons[0];
+
+        // Problemas asignados
+        json arr = pgrow::decodeRows<AssignedProblemColumns>(batch.result(1));
 
         res.status = 200;
-        res.set_content(json{{"success",true},{"marathon",m},{"problems",arr}}.dump(),"application/json");
+        res.set_content(dumpTimed(json{{"success",true},{"marathon",m},{"problems",arr}}),"application/json");
+    });
+
+    // Ticket de un solo uso para abrir el flujo de eventos con EventSource
+    router.Post("/api/marathons/{int}/events/ticket", [&](const auto& req, auto& res, const RouteParams& ruta) {
+        res.set_header("Content-Type","application/json");
+        AuthUser u = verifyTokenAndGetUser(req);
+        if (!u.isAuthenticated) {
+            res.status = 401; res.set_content(json{{"success",false},{"message","No autenticado"}}.dump(),"application/json");
+            return;
+        }
+        res.status = 200;
+        res.set_content(json{{"success",true},
+                             {"ticket",streamTickets.issue(ruta.integer(0), u.userId)},
+                             {"expires_in",eventsCfg.ticketTtl}}.dump(),"application/json");
+    });
+
+    // Flujo SSE con los cambios de la maratón (sustituye al sondeo)
+    router.Get("/api/marathons/{int}/events", [&](const auto& req, auto& res, const RouteParams& ruta) {
+        // EventSource no permite cabeceras: se acepta un ticket en ?ticket=
+        // (POST .../events/ticket) en lugar del JWT
+        AuthUser u = verifyTokenAndGetUser(req);
+        if (!u.isAuthenticated && req.has_param("ticket")) {
+            if (auto uid = streamTickets.redeem(req.get_param_value("ticket"), ruta.integer(0))) {
+                u.isAuthenticated = true;
+                u.userId = *uid;
+            }
+        }
+        if (!u.isAuthenticated) {
+            res.status = 401; res.set_content(json{{"success",false},{"message","No autenticado"}}.dump(),"application/json");
+            return;
+        }
+        std::string mid = ruta.text(0);
+        const char* p[1] = { mid.c_str() };
+        auto conn = db.acquire();
+        PGresult* r = timedExecParams(conn, "SELECT 1 FROM marathons WHERE id=$1", 1,NULL,p,NULL,NULL,0);
+        bool found = PQresultStatus(r)==PGRES_TUPLES_OK && PQntuples(r)==1;
+        PQclear(r);
+        if (!found) {
+            res.status = 404; res.set_content(json{{"success",false},{"message","No encontrada"}}.dump(),"application/json");
+            return;
+        }
+
+        // Al abrir un EventSource nuevo (ticket nuevo) el navegador no envía
+        // Last-Event-ID: el cliente lo pasa en ?last_event_id=
+        uint64_t lastId = 0;
+        try {
+            if (req.has_header("Last-Event-ID")) lastId = std::stoull(req.get_header_value("Last-Event-ID"));
+            else if (req.has_param("last_event_id")) lastId = std::stoull(req.get_param_value("last_event_id"));
+        } catch (...) {}
+        int64_t marathon = ruta.integer(0);
+        auto sub = events.subscribe(marathon, lastId);
+        if (!sub) {
+            res.status = 503; res.set_content(json{{"success",false},{"message","Demasiados clientes de eventos"}}.dump(),"application/json");
+            return;
+        }
+
+        res.set_header("Cache-Control","no-cache");
+        res.set_header("X-Accel-Buffering","no");
+        res.set_chunked_content_provider("text/event-stream",
+            [sub](size_t offset, httplib::DataSink& sink) {
+                if (offset == 0) {
+                    static const std::string hello = "retry: 3000\n\n";
+                    return sink.write(hello.data(), hello.size());
+                }
+                std::vector<MarathonEventBus::Frame> frames;
+                if (!sub->wait(frames, std::chrono::seconds(15))) {
+                    sink.done();
+                    return true;
+                }
+                if (frames.empty()) {
+                    // Comentario SSE para que proxies y navegador no corten
+                    static const std::string ping = ": ping\n\n";
+                    return sink.write(ping.data(), ping.size());
+                }
+                for (const auto& f : frames) {
+                    if (!sink.write(f->data(), f->size())) return false;
+                }
+                return true;
+            },
+            [&events, sub, marathon](bool) { events.unsubscribe(marathon, sub); });
     });
 
     // Añadir problema a maratón (hasta límite)
-    svr.Post(R"(/api/marathons/(\d+)/problems)", [&](const auto& req, auto& res) {
+    router.Post("/api/marathons/{int}/problems", [&](const auto& req, auto& res, const RouteParams& ruta) {
         res.set_header("Content-Type","application/json");
         AuthUser u = verifyTokenAndGetUser(req);
         if (!u.isAuthenticated || (u.role!="admin" && u.role!="professor")) {
             res.status = 403; res.set_content(json{{"success",false},{"message","Permiso denegado"}}.dump(),"application/json");
             return;
         }
-        std::string mid = req.matches[1];
+        std::string mid = ruta.text(0);
         try {
             json body = json::parse(req.body);
             int pid = body.at("problem_id");
-            const char* p_mid[1] = { mid.c_str() };
-
-            // Verificar límite
-            PGresult* r1 = PQexecParams(conn,
-              "SELECT max_problems,(SELECT COUNT(*) FROM marathon_problems WHERE marathon_id=$1) "
-              "FROM marathons WHERE id=$1",
-              1,NULL,p_mid,NULL,NULL,0);
-            int maxp = std::stoi(PQgetvalue(r1,0,0));
-            int cnt  = std::stoi(PQgetvalue(r1,0,1));
-            PQclear(r1);
-            if (cnt >= maxp) {
-                res.status = 400;
-                res.set_content(json{{"success",false},{"message","Límite alcanzado"}}.dump(),"application/json");
-                return;
+
+            // Verificar límite e insertar de forma atómica
+            auto conn = db.acquire();
+            AssignResult a = assignProblems(conn, mid, {pid});
+            if (a.status == 201) {
+                events.publish(ruta.integer(0), "problems_assigned",
+                               json{{"marathon_id",ruta.integer(0)},{"problem_ids",{pid}}}.dump());
             }
+            res.status = a.status;
+            res.set_content(json{{"success",a.status==201},{"message",a.message}}.dump(),"application/json");
+        } catch (const PgPool::Timeout& e) {
+            res.status = 503;
+            res.set_content(json{{"success",false},{"message",e.what()}}.dump(),"application/json");
+        } catch (...) {
+            res.status = 400;
+            res.set_content(json{{"success",false},{"message","Datos inválidos"}}.dump(),"application/json");
+        }
+    });
 
-            const char* p2[2] = { std::to_string(pid).c_str(), mid.c_str() };
-            PGresult* r2 = PQexecParams(conn,
-              "INSERT INTO marathon_problems (problem_id,marathon_id) VALUES($1,$2)",
-              2,NULL,p2,NULL,NULL,0);
-            if (PQresultStatus(r2)==PGRES_COMMAND_OK) {
-                res.status = 201;
-                res.set_content(json{{"success",true},{"message","Problema asignado"}}.dump(),"application/json");
-            } else {
-                res.status = 500;
-                res.set_content(json{{"success",false},{"message","Error al asignar"}}.dump(),"application/json");
+    // Añadir varios problemas a maratón (todos o ninguno)
+    router.Post("/api/marathons/{int}/problems/batch", [&](const auto& req, auto& res, const RouteParams& ruta) {
+        res.set_header("Content-Type","application/json");
+        AuthUser u = verifyTokenAndGetUser(req);
+        if (!u.isAuthenticated || (u.role!="admin" && u.role!="professor")) {
+            res.status = 403; res.set_content(json{{"success",false},{"message","Permiso denegado"}}.dump(),"application/json");
+            return;
+        }
+        std::string mid = ruta.text(0);
+        try {
+            json body = json::parse(req.body);
+            std::vector<int> pids = body.at("problem_ids");
+
+            auto conn = db.acquire();
+            AssignResult a = assignProblems(conn, mid, pids);
+            if (a.status == 201) {
+                events.publish(ruta.integer(0), "problems_assigned",
+                               json{{"marathon_id",ruta.integer(0)},{"problem_ids",pids}}.dump());
             }
-            PQclear(r2);
+            res.status = a.status;
+            res.set_content(json{{"success",a.status==201},{"message",a.message},{"assigned",a.assigned}}.dump(),"application/json");
+        } catch (const PgPool::Timeout& e) {
+            res.status = 503;
+            res.set_content(json{{"success",false},{"message",e.what()}}.dump(),"application/json");
         } catch (...) {
             res.status = 400;
             res.set_content(json{{"success",false},{"message","Datos inválidos"}}.dump(),"application/json");
@@ -379,7 +654,7 @@ int main() {
     });
 
     // Eliminar problema
-svr.Delete(R"(/api/problems/(\d+))", [&](const auto& req, auto& res) {
+router.Delete("/api/problems/{int}", [&](const auto& req, auto& res, const RouteParams& ruta) {
     res.set_header("Content-Type","application/json");
     AuthUser u = verifyTokenAndGetUser(req);
     if (!u.isAuthenticated || (u.role!="admin" && u.role!="professor")) {
@@ -387,31 +662,30 @@ svr.Delete(R"(/api/problems/(\d+))", [&](const auto& req, auto& res) {
         res.set_content(json{{"success",false},{"message","Permiso denegado"}}.dump(),"application/json");
         return;
     }
-    std::string pid = req.matches[1];
-    const char* p_pid[1] = { pid.c_str() };
-    
-    // Primero eliminar referencias en marathon_problems
-    PGresult* r1 = PQexecParams(conn,
-        "DELETE FROM marathon_problems WHERE problem_id=$1",
-        1,NULL,p_pid,NULL,NULL,0);
-    PQclear(r1);
+    std::string pid = ruta.text(0);
     
-    // Luego eliminar el problema
-    PGresult* r2 = PQexecParams(conn,
-        "DELETE FROM problems WHERE id=$1",
-        1,NULL,p_pid,NULL,NULL,0);
-    if (PQresultStatus(r2)==PGRES_COMMAND_OK) {
+    // Eliminar referencias en marathon_problems y luego el problema
+    auto conn = db.acquire();
+    QueryBatch batch(conn);
+    batch.add("DELETE FROM marathon_problems WHERE problem_id=$1 RETURNING marathon_id", {pid});
+    batch.add("DELETE FROM problems WHERE id=$1", {pid});
+    if (batch.run()) {
+        PGresult* affected = batch.result(0);
+        for (int i = 0; i < PQntuples(affected); ++i) {
+            int64_t marathon = std::stoll(PQgetvalue(affected, i, 0));
+            events.publish(marathon, "problem_removed",
+                           json{{"marathon_id",marathon},{"problem_id",ruta.integer(0)}}.dump());
+        }
         res.status = 200;
         res.set_content(json{{"success",true},{"message","Problema eliminado"}}.dump(),"application/json");
     } else {
         res.status = 500;
         res.set_content(json{{"success",false},{"message","Error al eliminar"}}.dump(),"application/json");
     }
-    PQclear(r2);
 });
 
 // Eliminar problema de maratón
-svr.Delete(R"(/api/marathons/(\d+)/problems/(\d+))", [&](const auto& req, auto& res) {
+router.Delete("/api/marathons/{int}/problems/{int}", [&](const auto& req, auto& res, const RouteParams& ruta) {
     res.set_header("Content-Type","application/json");
     AuthUser u = verifyTokenAndGetUser(req);
     if (!u.isAuthenticated || (u.role!="admin" && u.role!="professor")) {
@@ -419,14 +693,19 @@ svr.Delete(R"(/api/marathons/(\d+)/problems/(\d+))", [&](const auto& req, auto&
         res.set_content(json{{"success",false},{"message","Permiso denegado"}}.dump(),"application/json");
         return;
     }
-    std::string mid = req.matches[1];
-    std::string pid = req.matches[2];
+    std::string mid = ruta.text(0);
+    std::string pid = ruta.text(1);
     const char* p[2] = { mid.c_str(), pid.c_str() };
     
-    PGresult* r = PQexecParams(conn,
+    auto conn = db.acquire();
+    PGresult* r = timedExecParams(conn,
         "DELETE FROM marathon_problems WHERE marathon_id=$1 AND problem_id=$2",
         2,NULL,p,NULL,NULL,0);
     if (PQresultStatus(r)==PGRES_COMMAND_OK) {
+        if (std::string(PQcmdTuples(r)) != "0") {
+            events.publish(ruta.integer(0), "problem_removed",
+                           json{{"marathon_id",ruta.integer(0)},{"problem_id",ruta.integer(1)}}.dump());
+        }
         res.status = 200;
         res.set_content(json{{"success",true},{"message","Problema eliminado de la maratón"}}.dump(),"application/json");
     } else {
@@ -438,7 +717,7 @@ svr.Delete(R"(/api/marathons/(\d+)/problems/(\d+))", [&](const auto& req, auto&
 
 
 // Eliminar maratón
-svr.Delete(R"(/api/marathons/(\d+))", [&](const auto& req, auto& res) {
+router.Delete("/api/marathons/{int}", [&](const auto& req, auto& res, const RouteParams& ruta) {
     res.set_header("Content-Type","application/json");
     AuthUser u = verifyTokenAndGetUser(req);
     if (!u.isAuthenticated || (u.role!="admin" && u.role!="professor")) {
@@ -446,36 +725,27 @@ svr.Delete(R"(/api/marathons/(\d+))", [&](const auto& req, auto& res) {
         res.set_content(json{{"success",false},{"message","Permiso denegado"}}.dump(),"application/json");
         return;
     }
-    std::string mid = req.matches[1];
-    const char* p_mid[1] = { mid.c_str() };
-    
-    // Eliminar registros y problemas asociados
-    PGresult* r1 = PQexecParams(conn,
-        "DELETE FROM marathon_registrations WHERE marathon_id=$1",
-        1,NULL,p_mid,NULL,NULL,0);
-    PQclear(r1);
+    std::string mid = ruta.text(0);
     
-    PGresult* r2 = PQexecParams(conn,
-        "DELETE FROM marathon_problems WHERE marathon_id=$1",
-        1,NULL,p_mid,NULL,NULL,0);
-    PQclear(r2);
-    
-    // Eliminar la maratón
-    PGresult* r3 = PQexecParams(conn,
-        "DELETE FROM marathons WHERE id=$1",
-        1,NULL,p_mid,NULL,NULL,0);
-    if (PQresultStatus(r3)==PGRES_COMMAND_OK) {
+    // Eliminar registros, problemas asociados y la maratón en un solo lote
+    auto conn = db.acquire();
+    QueryBatch batch(conn);
+    batch.add("DELETE FROM marathon_registrations WHERE marathon_id=$1", {mid});
+    batch.add("DELETE FROM marathon_problems WHERE marathon_id=$1", {mid});
+    batch.add("DELETE FROM marathons WHERE id=$1", {mid});
+    if (batch.run()) {
+        events.publish(ruta.integer(0), "marathon_deleted", json{{"marathon_id",ruta.integer(0)}}.dump());
+        events.closeTopic(ruta.integer(0));
         res.status = 200;
         res.set_content(json{{"success",true},{"message","Maratón eliminada"}}.dump(),"application/json");
     } else {
         res.status = 500;
         res.set_content(json{{"success",false},{"message","Error al eliminar"}}.dump(),"application/json");
     }
-    PQclear(r3);
 });
 
 // Ver estudiantes registrados en una maratón
-svr.Get(R"(/api/marathons/(\d+)/students)", [&](const auto& req, auto& res) {
+router.Get("/api/marathons/{int}/students", [&](const auto& req, auto& res, const RouteParams& ruta) {
     res.set_header("Content-Type","application/json");
     AuthUser u = verifyTokenAndGetUser(req);
     if (!u.isAuthenticated) {
@@ -483,29 +753,20 @@ svr.Get(R"(/api/marathons/(\d+)/students)", [&](const auto& req, auto& res) {
         res.set_content(json{{"success",false},{"message","No autenticado"}}.dump(),"application/json");
         return;
     }
-    std::string mid = req.matches[1];
-    const char* p_mid[1] = { mid.c_str() };
+    std::string mid = ruta.text(0);
     
-    PGresult* r = PQexecParams(conn,
+    auto conn = db.acquire();
+    json arr = pgrow::fetchRows<StudentColumns>(conn,
         "SELECT u.id,u.username,mr.registered_at "
         "FROM users u JOIN marathon_registrations mr ON u.id=mr.user_id "
         "WHERE mr.marathon_id=$1 AND u.role='student' ORDER BY mr.registered_at",
-        1,NULL,p_mid,NULL,NULL,0);
-    json arr = json::array();
-    for (int i=0;i<PQntuples(r);++i) {
-        arr.push_back({
-          {"id", std::stoi(PQgetvalue(r,i,0))},
-          {"username", PQgetvalue(r,i,1)},
-          {"registered_at", PQgetvalue(r,i,2)}
-        });
-    }
-    PQclear(r);
+        {mid});
     res.status = 200;
-    res.set_content(json{{"success",true},{"students",arr}}.dump(),"application/json");
+    res.set_content(dumpTimed(json{{"success",true},{"students",arr}}),"application/json");
 });
 
 // Eliminar estudiante de maratón
-svr.Delete(R"(/api/marathons/(\d+)/students/(\d+))", [&](const auto& req, auto& res) {
+router.Delete("/api/marathons/{int}/students/{int}", [&](const auto& req, auto& res, const RouteParams& ruta) {
     res.set_header("Content-Type","application/json");
     AuthUser u = verifyTokenAndGetUser(req);
     if (!u.isAuthenticated || (u.role!="admin" && u.role!="professor")) {
@@ -513,14 +774,19 @@ svr.Delete(R"(/api/marathons/(\d+)/students/(\d+))", [&](const auto& req, auto&
         res.set_content(json{{"success",false},{"message","Permiso denegado"}}.dump(),"application/json");
         return;
     }
-    std::string mid = req.matches[1];
-    std::string uid = req.matches[2];
+    std::string mid = ruta.text(0);
+    std::string uid = ruta.text(1);
     const char* p[2] = { uid.c_str(), mid.c_str() };
     
-    PGresult* r = PQexecParams(conn,
+    auto conn = db.acquire();
+    PGresult* r = timedExecParams(conn,
         "DELETE FROM marathon_registrations WHERE user_id=$1 AND marathon_id=$2",
         2,NULL,p,NULL,NULL,0);
     if (PQresultStatus(r)==PGRES_COMMAND_OK) {
+        if (std::string(PQcmdTuples(r)) != "0") {
+            events.publish(ruta.integer(0), "student_removed",
+                           json{{"marathon_id",ruta.integer(0)},{"user_id",ruta.integer(1)}}.dump());
+        }
         res.status = 200;
         res.set_content(json{{"success",true},{"message","Estudiante eliminado"}}.dump(),"application/json");
     } else {
@@ -532,7 +798,7 @@ svr.Delete(R"(/api/marathons/(\d+)/students/(\d+))", [&](const auto& req, auto&
 
     // --- ENDPOINTS DE PROBLEMAS ---
     // Crear problema
-    svr.Post("/api/problems", [&](const auto& req, auto& res) {
+    router.Post("/api/problems", [&](const auto& req, auto& res) {
         res.set_header("Content-Type","application/json");
         AuthUser u = verifyTokenAndGetUser(req);
         if (!u.isAuthenticated || (u.role!="admin"&&u.role!="professor")) {
@@ -557,7 +823,8 @@ svr.Delete(R"(/api/marathons/(\d+)/students/(\d+))", [&](const auto& req, auto&
               title.c_str(), desc.c_str(), difficulty.c_str(),
               std::to_string(user_id).c_str()
             };
-            PGresult* r = PQexecParams(conn,
+            auto conn = db.acquire();
+            PGresult* r = timedExecParams(conn,
               "INSERT INTO problems (title,description,difficulty,created_by) VALUES($1,$2,$3,$4) RETURNING id",
               4,NULL,p,NULL,NULL,0);
             if (PQresultStatus(r)==PGRES_TUPLES_OK) {
@@ -569,6 +836,9 @@ svr.Delete(R"(/api/marathons/(\d+)/students/(\d+))", [&](const auto& req, auto&
                 res.set_content(json{{"success",false},{"message","Error al crear problema"}}.dump(),"application/json");
             }
             PQclear(r);
+        } catch (const PgPool::Timeout& e) {
+            res.status = 503;
+            res.set_content(json{{"success",false},{"message",e.what()}}.dump(),"application/json");
         } catch(...) {
             res.status = 400;
             res.set_content(json{{"success",false},{"message","Datos inválidos"}}.dump(),"application/json");
@@ -576,7 +846,7 @@ svr.Delete(R"(/api/marathons/(\d+)/students/(\d+))", [&](const auto& req, auto&
     });
 
     // Listar problemas
-    svr.Get("/api/problems", [&](const auto& req, auto& res) {
+    router.Get("/api/problems", [&](const auto& req, auto& res) {
         res.set_header("Content-Type","application/json");
         AuthUser u = verifyTokenAndGetUser(req);
         if (!u.isAuthenticated) {
@@ -584,59 +854,40 @@ svr.Delete(R"(/api/marathons/(\d+)/students/(\d+))", [&](const auto& req, auto&
             res.set_content(json{{"success",false},{"message","No autenticado"}}.dump(),"application/json");
             return;
         }
-        PGresult* r = PQexec(conn,
+        auto conn = db.acquire();
+        json arr = pgrow::fetchRows<ProblemColumns>(conn,
             "SELECT p.id,p.title,p.description,p.difficulty,p.created_at,u.username "
             "FROM problems p JOIN users u ON p.created_by=u.id ORDER BY p.created_at DESC");
-        json arr = json::array();
-        for(int i=0;i<PQntuples(r);++i){
-            arr.push_back({
-              {"id", std::stoi(PQgetvalue(r,i,0))},
-              {"title", PQgetvalue(r,i,1)},
-              {"description", PQgetvalue(r,i,2)},
-              {"difficulty", PQgetvalue(r,i,3)},
-              {"created_at", PQgetvalue(r,i,4)},
-              {"created_by", PQgetvalue(r,i,5)}
-            });
-        }
-        PQclear(r);
         res.status = 200;
-        res.set_content(json{{"success",true},{"problems",arr}}.dump(),"application/json");
+        res.set_content(dumpTimed(json{{"success",true},{"problems",arr}}),"application/json");
     });
 
     // Detalle de problema
-    svr.Get(R"(/api/problems/(\d+))", [&](const auto& req, auto& res) {
+    router.Get("/api/problems/{int}", [&](const auto& req, auto& res, const RouteParams& ruta) {
         res.set_header("Content-Type","application/json");
         AuthUser u = verifyTokenAndGetUser(req);
         if (!u.isAuthenticated) {
             res.status = 401; res.set_content(json{{"success",false},{"message","No autenticado"}}.dump(),"application/json");
             return;
         }
-        std::string pid = req.matches[1];
-        const char* p_pid[1] = { pid.c_str() };
-        PGresult* r = PQexecParams(conn,
+        std::string pid = ruta.text(0);
+        auto conn = db.acquire();
+        auto rows = pgrow::fetchRows<ProblemColumns>(conn,
             "SELECT p.id,p.title,p.description,p.difficulty,p.created_at,u.username "
             "FROM problems p JOIN users u ON p.created_by=u.id WHERE p.id=$1",
-            1,NULL,p_pid,NULL,NULL,0);
-        if (PQntuples(r)==1) {
-            json pr = {
-              {"id", std::stoi(PQgetvalue(r,0,0))},
-              {"title", PQgetvalue(r,0,1)},
-              {"description", PQgetvalue(r,0,2)},
-              {"difficulty", PQgetvalue(r,0,3)},
-              {"created_at", PQgetvalue(r,0,4)},
-              {"created_by", PQgetvalue(r,0,5)}
-            };
+            {pid});
+        if (rows.size()==1) {
+            json pr = rows[0];
             res.status = 200;
-            res.set_content(json{{"success",true},{"problem",pr}}.dump(),"application/json");
+            res.set_content(dumpTimed(json{{"success",true},{"problem",pr}}),"application/json");
         } else {
             res.status = 404;
             res.set_content(json{{"success",false},{"message","No encontrado"}}.dump(),"application/json");
         }
-        PQclear(r);
     });
 
     // Inscribir estudiante en maratón
-    svr.Post(R"(/api/marathons/(\d+)/register)", [&](const auto& req, auto& res) {
+    router.Post("/api/marathons/{int}/register", [&](const auto& req, auto& res, const RouteParams& ruta) {
         res.set_header("Content-Type","application/json");
         AuthUser u = verifyTokenAndGetUser(req);
         if (!u.isAuthenticated || u.role!="student") {
@@ -644,12 +895,15 @@ svr.Delete(R"(/api/marathons/(\d+)/students/(\d+))", [&](const auto& req, auto&
             res.set_content(json{{"success",false},{"message","Solo estudiantes"}}.dump(),"application/json");
             return;
         }
-        std::string mid = req.matches[1];
+        std::string mid = ruta.text(0);
         const char* p[2] = { std::to_string(u.userId).c_str(), mid.c_str() };
-        PGresult* r = PQexecParams(conn,
+        auto conn = db.acquire();
+        PGresult* r = timedExecParams(conn,
             "INSERT INTO marathon_registrations (user_id,marathon_id) VALUES($1,$2)",
             2,NULL,p,NULL,NULL,0);
         if (PQresultStatus(r)==PGRES_COMMAND_OK) {
+            events.publish(ruta.integer(0), "student_registered",
+                           json{{"marathon_id",ruta.integer(0)},{"user_id",u.userId},{"username",u.username}}.dump());
             res.status = 201;
             res.set_content(json{{"success",true},{"message","Inscripción exitosa"}}.dump(),"application/json");
         } else {
@@ -666,7 +920,7 @@ svr.Delete(R"(/api/marathons/(\d+)/students/(\d+))", [&](const auto& req, auto&
     });
 
     // Ver mis inscripciones
-    svr.Get("/api/my-marathons", [&](const auto& req, auto& res) {
+    router.Get("/api/my-marathons", [&](const auto& req, auto& res) {
         res.set_header("Content-Type","application/json");
         AuthUser u = verifyTokenAndGetUser(req);
         if (!u.isAuthenticated || u.role!="student") {
@@ -674,30 +928,20 @@ svr.Delete(R"(/api/marathons/(\d+)/students/(\d+))", [&](const auto& req, auto&
             res.set_content(json{{"success",false},{"message","Solo estudiantes"}}.dump(),"application/json");
             return;
         }
-        const char* p[1] = { std::to_string(u.userId).c_str() };
-        PGresult* r = PQexecParams(conn,
+        auto conn = db.acquire();
+        json arr = pgrow::fetchRows<RegistrationColumns>(conn,
             "SELECT m.id,m.name,m.description,mr.registered_at "
             "FROM marathons m JOIN marathon_registrations mr ON m.id=mr.marathon_id "
             "WHERE mr.user_id=$1 ORDER BY mr.registered_at DESC",
-            1,NULL,p,NULL,NULL,0);
-        json arr = json::array();
-        for (int i=0;i<PQntuples(r);++i) {
-            arr.push_back({
-              {"id", std::stoi(PQgetvalue(r,i,0))},
-              {"name", PQgetvalue(r,i,1)},
-              {"description", PQgetvalue(r,i,2)},
-              {"registered_at", PQgetvalue(r,i,3)}
-            });
-        }
-        PQclear(r); 
+            {std::to_string(u.userId)});
         res.status = 200;
-        res.set_content(json{{"success",true},{"marathons",arr}}.dump(),"application/json");
+        res.set_content(dumpTimed(json{{"success",true},{"marathons",arr}}),"application/json");
     });
 
 
 // --- ENDPOINTS DE USUARIOS ---
 // Listar usuarios
-svr.Get("/api/users", [&](const auto& req, auto& res) {
+router.Get("/api/users", [&](const auto& req, auto& res) {
     res.set_header("Content-Type","application/json");
     AuthUser u = verifyTokenAndGetUser(req);
     if (!u.isAuthenticated) {
@@ -719,28 +963,27 @@ svr.Get("/api/users", [&](const auto& req, auto& res) {
         return;
     }
     
-    PGresult* r = PQexec(conn, query.c_str());
     json arr = json::array();
-    for (int i=0;i<PQntuples(r);++i) {
+    auto conn = db.acquire();
+    for (const auto& row : pgrow::fetchRows<UserColumns>(conn, query.c_str())) {
         json user_obj;
-        user_obj["username"] = PQgetvalue(r,i,1);
-        user_obj["role"] = PQgetvalue(r,i,2);
+        user_obj["username"] = row.username;
+        user_obj["role"] = row.role;
         
         // Solo incluir ID y fecha de creación para administradores
         if (u.role == "admin") {
-            user_obj["id"] = std::stoi(PQgetvalue(r,i,0));
-            user_obj["created_at"] = PQgetvalue(r,i,3);
+            user_obj["id"] = row.id;
+            user_obj["created_at"] = row.created_at;
         }
         
         arr.push_back(user_obj);
     }
-    PQclear(r);
     res.status = 200;
-    res.set_content(json{{"success",true},{"users",arr}}.dump(),"application/json");
+    res.set_content(dumpTimed(json{{"success",true},{"users",arr}}),"application/json");
 });
 
 // Actualizar perfil propio
-svr.Put("/api/profile", [&](const auto& req, auto& res) {
+router.Put("/api/profile", [&](const auto& req, auto& res) {
     res.set_header("Content-Type","application/json");
     AuthUser u = verifyTokenAndGetUser(req);
     if (!u.isAuthenticated) {
@@ -756,7 +999,8 @@ svr.Put("/api/profile", [&](const auto& req, auto& res) {
         
         std::string pwd_hash = hash_password(password);
         const char* params[3] = { username.c_str(), pwd_hash.c_str(), std::to_string(u.userId).c_str() };
-        PGresult* r = PQexecParams(conn,
+        auto conn = db.acquire();
+        PGresult* r = timedExecParams(conn,
             "UPDATE users SET username=$1, password_hash=$2 WHERE id=$3",
             3, NULL, params, NULL, NULL, 0);
         
@@ -774,6 +1018,9 @@ svr.Put("/api/profile", [&](const auto& req, auto& res) {
             }
         }
         PQclear(r);
+    } catch (const PgPool::Timeout& e) {
+        res.status = 503;
+        res.set_content(json{{"success",false},{"message",e.what()}}.dump(),"application/json");
     } catch (...) {
         res.status = 400;
         res.set_content(json{{"success",false},{"message","Datos inválidos"}}.dump(),"application/json");
@@ -781,7 +1028,7 @@ svr.Put("/api/profile", [&](const auto& req, auto& res) {
 });
 
 // Actualizar usuario (solo admin)
-svr.Put(R"(/api/users/(\d+))", [&](const auto& req, auto& res) {
+router.Put("/api/users/{int}", [&](const auto& req, auto& res, const RouteParams& ruta) {
     res.set_header("Content-Type","application/json");
     AuthUser u = verifyTokenAndGetUser(req);
     if (!u.isAuthenticated || u.role != "admin") {
@@ -790,7 +1037,7 @@ svr.Put(R"(/api/users/(\d+))", [&](const auto& req, auto& res) {
         return;
     }
     
-    std::string uid = req.matches[1];
+    std::string uid = ruta.text(0);
     try {
         json body = json::parse(req.body);
         std::string username = body.at("username");
@@ -805,7 +1052,8 @@ svr.Put(R"(/api/users/(\d+))", [&](const auto& req, auto& res) {
         
         std::string pwd_hash = hash_password(password);
         const char* params[4] = { username.c_str(), pwd_hash.c_str(), role.c_str(), uid.c_str() };
-        PGresult* r = PQexecParams(conn,
+        auto conn = db.acquire();
+        PGresult* r = timedExecParams(conn,
             "UPDATE users SET username=$1, password_hash=$2, role=$3 WHERE id=$4",
             4, NULL, params, NULL, NULL, 0);
         
@@ -823,6 +1071,9 @@ svr.Put(R"(/api/users/(\d+))", [&](const auto& req, auto& res) {
             }
         }
         PQclear(r);
+    } catch (const PgPool::Timeout& e) {
+        res.status = 503;
+        res.set_content(json{{"success",false},{"message",e.what()}}.dump(),"application/json");
     } catch (...) {
         res.status = 400;
         res.set_content(json{{"success",false},{"message","Datos inválidos"}}.dump(),"application/json");
@@ -830,7 +1081,7 @@ svr.Put(R"(/api/users/(\d+))", [&](const auto& req, auto& res) {
 });
 
 // Eliminar usuario (solo admin)
-svr.Delete(R"(/api/users/(\d+))", [&](const auto& req, auto& res) {
+router.Delete("/api/users/{int}", [&](const auto& req, auto& res, const RouteParams& ruta) {
     res.set_header("Content-Type","application/json");
     AuthUser u = verifyTokenAndGetUser(req);
     if (!u.isAuthenticated || u.role != "admin") {
@@ -839,46 +1090,174 @@ svr.Delete(R"(/api/users/(\d+))", [&](const auto& req, auto& res) {
         return;
     }
     
-    std::string uid = req.matches[1];
+    std::string uid = ruta.text(0);
     if (std::stoi(uid) == u.userId) {
         res.status = 400;
         res.set_content(json{{"success",false},{"message","No puedes eliminarte a ti mismo"}}.dump(),"application/json");
         return;
     }
     
-    const char* p_uid[1] = { uid.c_str() };
-    
-    // Eliminar registros de maratón
-    PGresult* r1 = PQexecParams(conn,
-        "DELETE FROM marathon_registrations WHERE user_id=$1",
-        1,NULL,p_uid,NULL,NULL,0);
-    PQclear(r1);
-    
-    // Eliminar el usuario
-    PGresult* r2 = PQexecParams(conn,
-        "DELETE FROM users WHERE id=$1",
-        1,NULL,p_uid,NULL,NULL,0);
-    if (PQresultStatus(r2)==PGRES_COMMAND_OK) {
+    // Eliminar registros de maratón y luego el usuario
+    auto conn = db.acquire();
+    QueryBatch batch(conn);
+    batch.add("DELETE FROM marathon_registrations WHERE user_id=$1", {uid});
+    batch.add("DELETE FROM users WHERE id=$1", {uid});
+    if (batch.run()) {
         res.status = 200;
         res.set_content(json{{"success",true},{"message","Usuario eliminado"}}.dump(),"application/json");
     } else {
         res.status = 500;
         res.set_content(json{{"success",false},{"message","Error al eliminar"}}.dump(),"application/json");
     }
-    PQclear(r2);
 });
 
 
+    // --- ENDPOINT: Lote de sub-peticiones ---
+    // {"requests":[{"id":"me","method":"GET","path":"/api/me"}, ...]}
+    // Verifica el token una vez y ejecuta cada sub-petición con el handler
+    // registrado en el router. Van en orden y cada una toma y devuelve su
+    // conexión del pool; el lote no retiene ninguna mientras tanto.
+    router.Post("/api/batch", [&](const auto& req, auto& res) {
+        res.set_header("Content-Type","application/json");
+        json items;
+        try {
+            items = json::parse(req.body).at("requests");
+        } catch (...) {
+            res.status = 400;
+            res.set_content(json{{"success",false},{"message","Datos inválidos"}}.dump(),"application/json");
+            return;
+        }
+        if (!items.is_array() || items.empty() || items.size() > BATCH_MAX_REQUESTS) {
+            res.status = 400;
+            res.set_content(json{{"success",false},{"message","Entre 1 y " + std::to_string(BATCH_MAX_REQUESTS) + " peticiones"}}.dump(),"application/json");
+            return;
+        }
+
+        AuthUser u = verifyTokenAndGetUser(req);
+        json out = json::array();
+        for (const auto& item : items) {
+            // Cada entrada se valida por separado: una mal formada no tumba el lote
+            bool valid = item.is_object() &&
+                         (!item.contains("method") || item["method"].is_string()) &&
+                         item.contains("path") && item["path"].is_string();
+            json result = {{"id", item.is_object() ? item.value("id", json()) : json()}};
+            if (!valid) {
+                result["status"] = 400;
+                result["body"] = {{"success",false},{"message","Entrada inválida: se esperaba {id, method, path, body}"}};
+                out.push_back(std::move(result));
+                continue;
+            }
+            httplib::Request sub;
+            sub.method = item.value("method", std::string("GET"));
+            std::string target = item["path"].get<std::string>();
+            size_t q = target.find('?');
+            sub.path = httplib::detail::decode_url(target.substr(0, q), false);
+            if (q != std::string::npos) httplib::detail::parse_query_text(target.substr(q + 1), sub.params);
+            if (item.contains("body")) {
+                const json& b = item["body"];
+                sub.body = b.is_string() ? b.get<std::string>() : b.dump();
+                sub.set_header("Content-Type", "application/json");
+            }
+            if (req.has_header("Authorization")) sub.set_header("Authorization", req.get_header_value("Authorization"));
+
+            RouteParams params;
+            const TrieRouter::Handler* handler = nullptr;
+            bool allowed = sub.method == "GET" || sub.method == "POST" || sub.method == "PUT" || sub.method == "DELETE";
+            if (allowed && sub.path.rfind("/api/", 0) == 0 && sub.path != "/api/batch") {
+                handler = router.match(sub.method, sub.path, params);
+            }
+            if (!handler) {
+                result["status"] = 404;
+                result["body"] = {{"success",false},{"message","Ruta no encontrada"}};
+                out.push_back(std::move(result));
+                continue;
+            }
+            if (isStreamingRoute(sub.method, sub.path)) {
+                result["status"] = 400;
+                result["body"] = {{"success",false},{"message","No disponible en lote"}};
+                out.push_back(std::move(result));
+                continue;
+            }
+
+            httplib::Response subRes;
+            batchRequest = &sub;
+            batchUser = u;
+            try {
+                (*handler)(sub, subRes, params);
+            } catch (const PgPool::Timeout& e) {
+                subRes.status = 503;
+                subRes.set_content(json{{"success",false},{"message",e.what()}}.dump(),"application/json");
+            } catch (...) {
+                subRes.status = 500;
+                subRes.set_content(json{{"success",false},{"message","Error interno"}}.dump(),"application/json");
+            }
+            batchRequest = nullptr;
+
+            if (subRes.content_provider_) {
+                // Respaldo por si otra ruta empieza a responder con un flujo
+                result["status"] = 400;
+                result["body"] = {{"success",false},{"message","No disponible en lote"}};
+            } else {
+                result["status"] = subRes.status == -1 ? 200 : subRes.status;
+                json body = json::parse(subRes.body, nullptr, false);
+                result["body"] = body.is_discarded() ? json(subRes.body) : body;
+            }
+            out.push_back(std::move(result));
+        }
+        res.status = 200;
+        res.set_content(dumpTimed(json{{"success",true},{"responses",out}}),"application/json");
+    });
+
     // Health check
-    svr.Get("/api/health", [&](const auto&, auto& res) {
+    router.Get("/api/health", [&](const auto&, auto& res) {
         res.set_header("Content-Type","application/json");
         res.status = 200;
         res.set_content(json{{"status","OK"},{"message","Servidor OK"}}.dump(),"application/json");
     });
 
-    std::cout << "Servidor escuchando en http://localhost:8080\n";
-    svr.listen("0.0.0.0", 8080);
+    // --- MÉTRICAS (formato Prometheus) ---
+    // Rutas y fases se registran solas; aquí los gauges de ocupación
+    metrics::gauge("http_worker_threads", "Hilos del pool HTTP.",
+                   [] { return static_cast<double>(taskQueueStats().threads); });
+    metrics::gauge("http_worker_busy", "Hilos del pool atendiendo una conexión.",
+                   [] { return static_cast<double>(taskQueueStats().busy); });
+    metrics::gauge("http_queue_pending", "Conexiones esperando un hilo libre.",
+                   [] { return static_cast<double>(taskQueueStats().pending); });
+    metrics::gauge("http_queue_rejected", "Conexiones descartadas por cola llena desde el arranque.",
+                   [] { return static_cast<double>(taskQueueStats().rejected); });
+    metrics::gauge("pg_pool_size", "Conexiones a PostgreSQL en el pool.",
+                   [&] { return static_cast<double>(db.size()); });
+    metrics::gauge("pg_pool_available", "Conexiones a PostgreSQL libres.",
+                   [&] { return static_cast<double>(db.available()); });
+    metrics::gauge("sse_subscribers", "Clientes SSE conectados.",
+                   [&] { return static_cast<double>(events.subscribers()); });
+#ifdef __linux__
+    std::vector<const EpollServer*> reactors;
+    servers.each([&](httplib::Server& svr) {
+        if (auto* e = dynamic_cast<const EpollServer*>(&svr)) reactors.push_back(e);
+    });
+    if (!reactors.empty()) {
+        metrics::gauge("http_connections_open", "Conexiones abiertas en el reactor.", [reactors] {
+            size_t n = 0;
+            for (const auto* e : reactors) n += e->open();
+            return static_cast<double>(n);
+        });
+        metrics::gauge("http_connections_parked", "Conexiones keep-alive inactivas en epoll.", [reactors] {
+            size_t n = 0;
+            for (const auto* e : reactors) n += e->parked();
+            return static_cast<double>(n);
+        });
+    }
+#endif
+    router.Get("/metrics", [](const auto&, auto& res) {
+        res.set_content(metrics::renderPrometheus(), "text/plain; version=0.0.4");
+    });
 
-    PQfinish(conn);
+    std::cout << "Servidor escuchando en http://localhost:8080\n";
+    servers.each([&](httplib::Server& svr) {
+        router.install(svr, cors);
+        compressor.install(svr);
+    });
+    servers.listen("0.0.0.0", 8080);
     return 0;
 }
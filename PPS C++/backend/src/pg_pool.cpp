@@ -0,0 +1,81 @@
+#include "pg_pool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+size_t readSize(const char* name, size_t fallback) {
+    const char* v = std::getenv(name);
+    if (!v || !*v) return fallback;
+    try {
+        return static_cast<size_t>(std::stoull(v));
+    } catch (...) {
+        std::cerr << "Valor inválido para " << name << ": " << v << std::endl;
+        return fallback;
+    }
+}
+}
+
+PgPool::PgPool(const std::string& conninfo, size_t size, std::chrono::milliseconds waitTimeout)
+    : waitTimeout_(waitTimeout) {
+    for (size_t i = 0; i < std::max<size_t>(1, size); ++i) {
+        PGconn* conn = PQconnectdb(conninfo.c_str());
+        if (PQstatus(conn) != CONNECTION_OK) {
+            std::string err = PQerrorMessage(conn);
+            PQfinish(conn);
+            for (PGconn* c : all_) PQfinish(c);
+            throw std::runtime_error(err);
+        }
+        all_.push_back(conn);
+    }
+    idle_ = all_;
+}
+
+PgPool::~PgPool() {
+    for (PGconn* c : all_) PQfinish(c);
+}
+
+size_t PgPool::sizeFromEnv(size_t httpThreads) {
+    size_t size = readSize("PG_POOL_SIZE", 0);
+    return size ? size : std::clamp<size_t>(httpThreads, 1, 16);
+}
+
+std::chrono::milliseconds PgPool::timeoutFromEnv() {
+    return std::chrono::milliseconds(readSize("PG_POOL_TIMEOUT_MS", 5000));
+}
+
+PgPool::Lease PgPool::acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!cond_.wait_for(lock, waitTimeout_, [&] { return !idle_.empty(); })) {
+        throw Timeout("No hay conexiones libres a la base de datos");
+    }
+    PGconn* conn = idle_.back();
+    idle_.pop_back();
+    return Lease(this, conn);
+}
+
+size_t PgPool::available() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return idle_.size();
+}
+
+void PgPool::release(PGconn* conn) {
+    // La siguiente petición recibe la conexión limpia: sin lote a medias,
+    // sin transacción abierta y reconectada si se cayó
+    if (PQstatus(conn) != CONNECTION_OK) {
+        PQreset(conn);
+    } else {
+#ifdef LIBPQ_HAS_PIPELINING
+        if (PQpipelineStatus(conn) != PQ_PIPELINE_OFF) {
+            while (PGresult* r = PQgetResult(conn)) PQclear(r);
+            PQexitPipelineMode(conn);
+        }
+#endif
+        if (PQtransactionStatus(conn) != PQTRANS_IDLE) PQclear(PQexec(conn, "ROLLBACK"));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(conn);
+    }
+    cond_.notify_one();
+}
@@ -0,0 +1,72 @@
+#ifndef PG_POOL_H
+#define PG_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "libpq-fe.h"
+
+// --- POOL DE CONEXIONES A POSTGRESQL ---
+// Un PGconn no admite dos hilos a la vez: las sentencias se mezclarían y un
+// lote en modo pipeline (QueryBatch) rechazaría las del otro hilo. Cada
+// petición toma su propia conexión con acquire() y la devuelve al salir del
+// ámbito. Así las transacciones y los FOR UPDATE de una petición son de
+// verdad independientes de las demás.
+class PgPool {
+public:
+    // Se lanza cuando no hay conexiones libres dentro del tiempo de espera.
+    struct Timeout : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    // Conexión prestada; vuelve al pool al destruirse (RAII).
+    class Lease {
+    public:
+        Lease(Lease&& other) noexcept : pool_(other.pool_), conn_(other.conn_) { other.conn_ = nullptr; }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        Lease& operator=(Lease&&) = delete;
+        ~Lease() { if (conn_) pool_->release(conn_); }
+
+        PGconn* get() const { return conn_; }
+        operator PGconn*() const { return conn_; }
+
+    private:
+        friend class PgPool;
+        Lease(PgPool* pool, PGconn* conn) : pool_(pool), conn_(conn) {}
+
+        PgPool* pool_;
+        PGconn* conn_;
+    };
+
+    // Abre `size` conexiones; lanza std::runtime_error si alguna falla.
+    PgPool(const std::string& conninfo, size_t size, std::chrono::milliseconds waitTimeout);
+    ~PgPool();
+
+    PgPool(const PgPool&) = delete;
+    PgPool& operator=(const PgPool&) = delete;
+
+    // PG_POOL_SIZE (0 = según hilos HTTP, hasta 16) y PG_POOL_TIMEOUT_MS
+    static size_t sizeFromEnv(size_t httpThreads);
+    static std::chrono::milliseconds timeoutFromEnv();
+
+    Lease acquire();
+
+    size_t size() const { return all_.size(); }
+    size_t available() const;
+
+private:
+    void release(PGconn* conn);
+
+    std::chrono::milliseconds waitTimeout_;
+    std::vector<PGconn*> all_;
+    mutable std::mutex mutex_;
+    std::condition_variable cond_;
+    std::vector<PGconn*> idle_;
+};
+
+#endif // PG_POOL_H
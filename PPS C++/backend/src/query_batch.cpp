@@ -0,0 +1,112 @@
+#include "query_batch.h"
+#include "metrics.h"
+
+QueryBatch::QueryBatch(PGconn* conn) : conn(conn) {}
+
+QueryBatch::~QueryBatch() {
+    for (PGresult* r : results) {
+        if (r) PQclear(r);
+    }
+}
+
+size_t QueryBatch::add(const char* sql, std::vector<std::string> params, bool binary) {
+    queries.push_back({sql, std::move(params), binary ? 1 : 0});
+    return queries.size() - 1;
+}
+
+bool QueryBatch::run() {
+    results.assign(queries.size(), nullptr);
+    if (queries.empty()) return true;
+    static const metrics::SeriesId db = metrics::phase("db");
+    metrics::ScopedTimer timer(db);
+#ifdef LIBPQ_HAS_PIPELINING
+    if (PQpipelineStatus(conn) == PQ_PIPELINE_OFF && PQenterPipelineMode(conn)) {
+        return runPipelined();
+    }
+#endif
+    return runSequential();
+}
+
+PGresult* QueryBatch::result(size_t i) const {
+    return i < results.size() ? results[i] : nullptr;
+}
+
+bool QueryBatch::ok(size_t i) const {
+    PGresult* r = result(i);
+    if (!r) return false;
+    ExecStatusType st = PQresultStatus(r);
+    return st == PGRES_COMMAND_OK || st == PGRES_TUPLES_OK;
+}
+
+bool QueryBatch::runPipelined() {
+#ifdef LIBPQ_HAS_PIPELINING
+    // Enviar todas las sentencias seguidas de un único punto de sincronización
+    size_t sent = 0;
+    for (const auto& q : queries) {
+        std::vector<const char*> values;
+        values.reserve(q.params.size());
+        for (const auto& p : q.params) values.push_back(p.c_str());
+        if (!PQsendQueryParams(conn, q.sql, static_cast<int>(values.size()),
+                               NULL, values.data(), NULL, NULL, q.format)) {
+            break;
+        }
+        ++sent;
+    }
+    PQpipelineSync(conn);
+
+    // Recoger un resultado por sentencia (cada uno termina con un NULL)
+    for (size_t i = 0; i < sent; ++i) {
+        PGresult* r = PQgetResult(conn);
+        if (!r) break;
+        results[i] = r;
+        while (PGresult* extra = PQgetResult(conn)) PQclear(extra);
+    }
+
+    // Consumir el resultado del punto de sincronización
+    while (PGresult* r = PQgetResult(conn)) {
+        bool sync = PQresultStatus(r) == PGRES_PIPELINE_SYNC;
+        PQclear(r);
+        if (sync) break;
+    }
+    PQexitPipelineMode(conn);
+
+    bool all_ok = sent == queries.size();
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (!ok(i)) all_ok = false;
+    }
+    return all_ok;
+#else
+    return runSequential();
+#endif
+}
+
+// Alternativa para libpq anteriores a la versión 14: mismo resultado
+// transaccional, pero con un viaje de red por sentencia.
+bool QueryBatch::runSequential() {
+    // Sin BEGIN confirmado cada sentencia iría en su propia transacción
+    PGresult* begin = PQexec(conn, "BEGIN");
+    bool began = PQresultStatus(begin) == PGRES_COMMAND_OK;
+    PQclear(begin);
+    if (!began) return false;
+
+    bool all_ok = true;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        results[i] = send(queries[i]);
+        if (!ok(i)) {
+            all_ok = false;
+            break;
+        }
+    }
+    PGresult* end = PQexec(conn, all_ok ? "COMMIT" : "ROLLBACK");
+    if (PQresultStatus(end) != PGRES_COMMAND_OK) all_ok = false;
+    PQclear(end);
+    return all_ok;
+}
+
+PGresult* QueryBatch::send(const Query& q) {
+    std::vector<const char*> values;
+    values.reserve(q.params.size());
+    for (const auto& p : q.params) values.push_back(p.c_str());
+    return PQexecParams(conn, q.sql, static_cast<int>(values.size()),
+                        NULL, values.data(), NULL, NULL, q.format);
+}
@@ -0,0 +1,53 @@
+#ifndef QUERY_BATCH_H
+#define QUERY_BATCH_H
+
+#include <string>
+#include <vector>
+#include "libpq-fe.h"
+
+// --- LOTE DE CONSULTAS (MODO PIPELINE DE LIBPQ) ---
+// Encola varias sentencias parametrizadas y las envía juntas al servidor,
+// pagando un solo viaje de red. Todas las sentencias del lote se ejecutan
+// dentro de la misma transacción implícita: si una falla, las anteriores se
+// revierten y las siguientes se omiten (quedan como PGRES_PIPELINE_ABORTED).
+// La conexión debe ser exclusiva del lote mientras dura (PgPool::acquire):
+// otro hilo sobre el mismo PGconn rompería el pipeline y la transacción.
+class QueryBatch {
+public:
+    explicit QueryBatch(PGconn* conn);
+    ~QueryBatch();
+
+    QueryBatch(const QueryBatch&) = delete;
+    QueryBatch& operator=(const QueryBatch&) = delete;
+
+    // Añade una sentencia al lote y devuelve su posición. Con binary=true
+    // el resultado llega en formato binario (ver row_decoder.h).
+    size_t add(const char* sql, std::vector<std::string> params = {}, bool binary = false);
+
+    // Envía el lote y recoge todos los resultados. Devuelve true si todas
+    // las sentencias terminaron correctamente.
+    bool run();
+
+    // Resultado de la sentencia i (propiedad del lote, no llamar a PQclear).
+    PGresult* result(size_t i) const;
+    bool ok(size_t i) const;
+
+    size_t size() const { return queries.size(); }
+
+private:
+    struct Query {
+        const char* sql;
+        std::vector<std::string> params;
+        int format;
+    };
+
+    bool runPipelined();
+    bool runSequential();
+    PGresult* send(const Query& q);
+
+    PGconn* conn;
+    std::vector<Query> queries;
+    std::vector<PGresult*> results;
+};
+
+#endif // QUERY_BATCH_H
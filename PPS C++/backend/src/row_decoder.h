@@ -0,0 +1,218 @@
+#ifndef ROW_DECODER_H
+#define ROW_DECODER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "libpq-fe.h"
+#include "metrics.h"
+
+// --- DECODIFICACIÓN TIPADA DE FILAS (FORMATO BINARIO) ---
+// Las consultas se piden con resultFormat=1 y cada columna se copia directo
+// al campo de un struct, sin pasar por texto + std::stoi. El orden de las
+// columnas del SELECT se fija en tiempo de compilación con Columns<...>:
+//
+//   using MarathonColumns = pgrow::Columns<&MarathonRow::id, &MarathonRow::name>;
+//   auto rows = pgrow::fetchRows<MarathonColumns>(conn, "SELECT id,name FROM ...");
+namespace pgrow {
+
+// OIDs de los tipos que sabemos decodificar (catálogo pg_type)
+constexpr Oid INT2OID        = 21;
+constexpr Oid INT4OID        = 23;
+constexpr Oid INT8OID        = 20;
+constexpr Oid DATEOID        = 1082;
+constexpr Oid TIMESTAMPOID   = 1114;
+constexpr Oid TIMESTAMPTZOID = 1184;
+constexpr Oid NAMEOID        = 19;
+constexpr Oid TEXTOID        = 25;
+constexpr Oid BPCHAROID      = 1042;
+constexpr Oid VARCHAROID     = 1043;
+// A partir de aquí los OIDs son de tipos creados por el usuario (enums)
+constexpr Oid FIRST_USER_OID = 16384;
+
+// Fecha/hora tal como la envía PostgreSQL: microsegundos desde 2000-01-01.
+struct Timestamp {
+    int64_t micros = 0;
+    bool withTz = false;
+
+    // ISO-8601; las columnas con zona horaria se expresan en UTC ("Z").
+    std::string str() const;
+};
+
+inline int64_t readBigEndian(const char* v, int len) {
+    const auto* b = reinterpret_cast<const unsigned char*>(v);
+    uint64_t x = 0;
+    for (int i = 0; i < len; ++i) x = (x << 8) | b[i];
+    // Extender el signo para enteros de 2 y 4 bytes
+    if (len < 8 && len > 0 && (b[0] & 0x80)) x |= ~uint64_t{0} << (len * 8);
+    return static_cast<int64_t>(x);
+}
+
+// Días desde 1970-01-01 a año/mes/día (calendario gregoriano proléptico)
+inline void civilFromDays(int64_t z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = static_cast<int>(yoe + era * 400 + (m <= 2));
+}
+
+inline std::string Timestamp::str() const {
+    constexpr int64_t US_PER_DAY = 86400LL * 1000000LL;
+    constexpr int64_t EPOCH_2000_DAYS = 10957; // 2000-01-01 - 1970-01-01
+
+    int64_t days = micros / US_PER_DAY;
+    int64_t rem  = micros % US_PER_DAY;
+    if (rem < 0) { rem += US_PER_DAY; --days; }
+
+    int y; unsigned mo, d;
+    civilFromDays(days + EPOCH_2000_DAYS, y, mo, d);
+    int64_t secs = rem / 1000000;
+    int64_t frac = rem % 1000000;
+
+    char buf[48];
+    int n = std::snprintf(buf, sizeof(buf), "%04d-%02u-%02uT%02d:%02d:%02d",
+                          y, mo, d, static_cast<int>(secs / 3600),
+                          static_cast<int>(secs / 60 % 60), static_cast<int>(secs % 60));
+    if (frac) {
+        // Igual que PostgreSQL: quitar ceros finales de la fracción
+        int digits = 6;
+        while (frac % 10 == 0) { frac /= 10; --digits; }
+        n += std::snprintf(buf + n, sizeof(buf) - n, ".%0*lld", digits, static_cast<long long>(frac));
+    }
+    std::string s(buf, n);
+    if (withTz) s += 'Z';
+    return s;
+}
+
+// Decodificador por tipo de campo; los NULL dejan el valor por defecto.
+// accepts() dice qué tipos de columna entiende: en binario un int8 leído
+// como int o un timestamp leído como texto darían basura sin error.
+template<typename T> struct Decoder;
+
+template<> struct Decoder<int64_t> {
+    static bool accepts(Oid type) {
+        return type == INT2OID || type == INT4OID || type == INT8OID;
+    }
+    static void decode(const char* v, int len, Oid, int64_t& out) {
+        out = readBigEndian(v, len);
+    }
+};
+
+template<> struct Decoder<int> {
+    static bool accepts(Oid type) { return type == INT2OID || type == INT4OID; }
+    static void decode(const char* v, int len, Oid, int& out) {
+        out = static_cast<int>(readBigEndian(v, len));
+    }
+};
+
+template<> struct Decoder<std::string> {
+    // text, varchar, name y enums viajan como bytes crudos en binario
+    static bool accepts(Oid type) {
+        return type == TEXTOID || type == VARCHAROID || type == BPCHAROID ||
+               type == NAMEOID || type >= FIRST_USER_OID;
+    }
+    static void decode(const char* v, int len, Oid, std::string& out) {
+        out.assign(v, len);
+    }
+};
+
+template<> struct Decoder<Timestamp> {
+    static bool accepts(Oid type) {
+        return type == DATEOID || type == TIMESTAMPOID || type == TIMESTAMPTZOID;
+    }
+    static void decode(const char* v, int len, Oid type, Timestamp& out) {
+        if (type == DATEOID) {
+            out.micros = readBigEndian(v, len) * 86400LL * 1000000LL;
+        } else {
+            out.micros = readBigEndian(v, len);
+            out.withTz = type == TIMESTAMPTZOID;
+        }
+    }
+};
+
+template<typename M> struct MemberTraits;
+template<typename C, typename T> struct MemberTraits<T C::*> {
+    using row_type = C;
+    using field_type = T;
+};
+
+// Mapeo columna -> campo fijado en tiempo de compilación.
+template<auto First, auto... Rest>
+struct Columns {
+    using row_type = typename MemberTraits<decltype(First)>::row_type;
+    static constexpr int count = 1 + sizeof...(Rest);
+
+    static void decode(const PGresult* r, int row, row_type& out) {
+        int col = 0;
+        decodeField<First>(r, row, col++, out);
+        (decodeField<Rest>(r, row, col++, out), ...);
+    }
+
+    // Comprueba una vez por resultado que cada columna sea de un tipo que
+    // su campo sabe decodificar; informa de la primera que no lo es.
+    static bool checkTypes(const PGresult* r) {
+        int col = 0;
+        return checkField<First>(r, col++) && (checkField<Rest>(r, col++) && ...);
+    }
+
+private:
+    template<auto Member>
+    static bool checkField(const PGresult* r, int col) {
+        using T = typename MemberTraits<decltype(Member)>::field_type;
+        Oid type = PQftype(r, col);
+        if (Decoder<T>::accepts(type)) return true;
+        std::fprintf(stderr, "pgrow: la columna %d (%s) es de tipo %u, no compatible con su campo\n",
+                     col, PQfname(r, col), static_cast<unsigned>(type));
+        return false;
+    }
+
+    template<auto Member>
+    static void decodeField(const PGresult* r, int row, int col, row_type& out) {
+        using T = typename MemberTraits<decltype(Member)>::field_type;
+        if (PQgetisnull(r, row, col)) return;
+        Decoder<T>::decode(PQgetvalue(r, row, col), PQgetlength(r, row, col),
+                           PQftype(r, col), out.*Member);
+    }
+};
+
+// Decodifica todas las filas de un resultado pedido en formato binario.
+template<typename Cols>
+std::vector<typename Cols::row_type> decodeRows(const PGresult* r) {
+    std::vector<typename Cols::row_type> rows;
+    if (!r || PQresultStatus(r) != PGRES_TUPLES_OK) return rows;
+    if (PQnfields(r) < Cols::count || PQbinaryTuples(r) != 1) return rows;
+    if (!Cols::checkTypes(r)) return rows;
+    int n = PQntuples(r);
+    rows.resize(n);
+    for (int i = 0; i < n; ++i) Cols::decode(r, i, rows[i]);
+    return rows;
+}
+
+// Ejecuta la consulta con resultados binarios y la decodifica.
+template<typename Cols>
+std::vector<typename Cols::row_type> fetchRows(PGconn* conn, const char* sql,
+                                               const std::vector<std::string>& params = {}) {
+    std::vector<const char*> values;
+    values.reserve(params.size());
+    for (const auto& p : params) values.push_back(p.c_str());
+    static const metrics::SeriesId db = metrics::phase("db");
+    PGresult* r;
+    {
+        metrics::ScopedTimer timer(db);
+        r = PQexecParams(conn, sql, static_cast<int>(values.size()),
+                         NULL, values.data(), NULL, NULL, 1);
+    }
+    auto rows = decodeRows<Cols>(r);
+    PQclear(r);
+    return rows;
+}
+
+} // namespace pgrow
+
+#endif // ROW_DECODER_H
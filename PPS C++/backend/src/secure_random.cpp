@@ -0,0 +1,88 @@
+#include "secure_random.h"
+#include <cstring>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <bcrypt.h>
+#elif defined(__linux__)
+#include <sys/random.h>
+#include <cerrno>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+// Búfer por hilo: los bytes ya entregados nunca se reutilizan.
+struct ThreadBuffer {
+    uint8_t data[4096];
+    size_t pos = sizeof(data);
+};
+thread_local ThreadBuffer pool;
+}
+
+void SecureRandom::refill(uint8_t* buf, size_t n) {
+#if defined(_WIN32)
+    if (BCryptGenRandom(NULL, buf, static_cast<ULONG>(n), BCRYPT_USE_SYSTEM_PREFERRED_RNG) != 0) {
+        throw std::runtime_error("BCryptGenRandom falló");
+    }
+#elif defined(__linux__)
+    size_t done = 0;
+    while (done < n) {
+        ssize_t r = getrandom(buf + done, n - done, 0);
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("getrandom falló");
+        }
+        done += static_cast<size_t>(r);
+    }
+#else
+    // getentropy entrega como máximo 256 bytes por llamada
+    for (size_t done = 0; done < n; done += 256) {
+        size_t len = n - done < 256 ? n - done : 256;
+        if (getentropy(buf + done, len) != 0) {
+            throw std::runtime_error("getentropy falló");
+        }
+    }
+#endif
+}
+
+void SecureRandom::fill(uint8_t* out, size_t n) {
+    static_assert(sizeof(ThreadBuffer::data) == BUFFER_SIZE, "tamaño de búfer");
+    // Peticiones grandes van directo al sistema
+    if (n > BUFFER_SIZE / 4) {
+        refill(out, n);
+        return;
+    }
+    while (n > 0) {
+        if (pool.pos == BUFFER_SIZE) {
+            refill(pool.data, BUFFER_SIZE);
+            pool.pos = 0;
+        }
+        size_t take = BUFFER_SIZE - pool.pos < n ? BUFFER_SIZE - pool.pos : n;
+        std::memcpy(out, pool.data + pool.pos, take);
+        // Borrar lo entregado para que no quede copia en el búfer
+        std::memset(pool.data + pool.pos, 0, take);
+        pool.pos += take;
+        out += take;
+        n -= take;
+    }
+}
+
+std::vector<uint8_t> SecureRandom::salt(size_t n) {
+    std::vector<uint8_t> s(n);
+    fill(s.data(), n);
+    return s;
+}
+
+std::string SecureRandom::token(size_t bytes) {
+    static const char hex[] = "0123456789abcdef";
+    std::vector<uint8_t> raw = salt(bytes);
+    std::string out;
+    out.reserve(bytes * 2);
+    for (uint8_t b : raw) {
+        out += hex[b >> 4];
+        out += hex[b & 0x0f];
+    }
+    return out;
+}
@@ -0,0 +1,30 @@
+#ifndef SECURE_RANDOM_H
+#define SECURE_RANDOM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// --- GENERADOR DE SALES Y NONCES ---
+// Bytes aleatorios del CSPRNG del sistema operativo (getrandom en Linux,
+// BCryptGenRandom en Windows). Cada hilo guarda un búfer propio que se
+// rellena con una sola llamada al sistema, así cientos de sales salen de
+// una misma recarga sin bloqueos entre hilos.
+class SecureRandom {
+public:
+    // Llena out con n bytes aleatorios.
+    static void fill(uint8_t* out, size_t n);
+
+    // Sal para hashing de contraseñas.
+    static std::vector<uint8_t> salt(size_t n = 16);
+
+    // Token en hexadecimal (ids de sesión, recuperación de contraseña...).
+    static std::string token(size_t bytes = 32);
+
+private:
+    static constexpr size_t BUFFER_SIZE = 4096;
+    static void refill(uint8_t* buf, size_t n);
+};
+
+#endif // SECURE_RANDOM_H
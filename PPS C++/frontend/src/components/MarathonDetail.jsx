@@ -1,6 +1,6 @@
-import React, { useEffect, useState } from 'react';
+import React, { useCallback, useEffect, useRef, useState } from 'react';
 import { useParams, Link, useNavigate } from 'react-router-dom';
-import { marathons, problems } from '../services/api';
+import { marathons, batch } from '../services/api';
 import { useAuth } from '../contexts/AuthContext';
 
 export default function MarathonDetail() {
@@ -17,16 +17,18 @@ export default function MarathonDetail() {
   useEffect(() => {
     async function fetch() {
       try {
-        const rM = await marathons.getById(id);
-        setMarathon(rM.data.marathon);
-        setAssigned(rM.data.problems);
-
-        const rP = await problems.getAll();
-        setAllProblems(rP.data.problems);
-
-        // Obtener estudiantes registrados
-        const rS = await marathons.getStudents(id);
-        setStudents(rS.data.students);
+        // Maratón, problemas y estudiantes en una sola petición
+        const r = await batch([
+          { id: 'marathon', method: 'GET', path: `/api/marathons/${id}` },
+          { id: 'problems', method: 'GET', path: '/api/problems' },
+          { id: 'students', method: 'GET', path: `/api/marathons/${id}/students` },
+        ]);
+        const [rM, rP, rS] = r.data.responses;
+        if (rM.status !== 200) throw new Error(rM.body?.message);
+        setMarathon(rM.body.marathon);
+        setAssigned(rM.body.problems);
+        setAllProblems(rP.body.problems || []);
+        setStudents(rS.body.students || []);
       } catch {
         setErr('Error cargando datos');
       } finally {
@@ -36,12 +38,80 @@ export default function MarathonDetail() {
     fetch();
   }, [id]);
 
-  const handleAdd = async pid => {
+  const reloadMarathon = useCallback(async () => {
     try {
-      await marathons.addProblem(id, pid);
       const r = await marathons.getById(id);
       setAssigned(r.data.problems);
       setMarathon(r.data.marathon);
+    } catch {}
+  }, [id]);
+
+  const reloadStudents = useCallback(async () => {
+    try {
+      const r = await marathons.getStudents(id);
+      setStudents(r.data.students);
+    } catch {}
+  }, [id]);
+
+  // true mientras el flujo SSE está abierto; si no, las acciones recargan
+  const live = useRef(false);
+  // La eliminación propia ya navega: el evento marathon_deleted no repite
+  const leaving = useRef(false);
+
+  // Cambios en vivo (SSE) en lugar de volver a consultar tras cada acción
+  useEffect(() => {
+    let source = null;
+    let closed = false;
+    let lastEventId = '';
+    let retry = null;
+
+    const track = handler => e => {
+      lastEventId = e.lastEventId || lastEventId;
+      handler(e);
+    };
+
+    const open = async () => {
+      try {
+        const s = await marathons.events(id, lastEventId);
+        if (closed) { s.close(); return; }
+        source = s;
+      } catch {
+        if (!closed) retry = setTimeout(open, 5000);
+        return;
+      }
+      source.onopen = () => { live.current = true; };
+      source.onerror = () => {
+        live.current = false;
+        // El ticket es de un solo uso: si el navegador no puede reconectar
+        // con él, se pide otro y se retoma desde el último evento
+        if (source.readyState === EventSource.CLOSED && !closed) {
+          retry = setTimeout(open, 3000);
+        }
+      };
+      source.addEventListener('problems_assigned', track(reloadMarathon));
+      source.addEventListener('problem_removed', track(reloadMarathon));
+      source.addEventListener('student_registered', track(reloadStudents));
+      source.addEventListener('student_removed', track(reloadStudents));
+      source.addEventListener('marathon_deleted', () => {
+        closed = true;
+        source.close();
+        if (!leaving.current) navigate('/marathons');
+      });
+    };
+    open();
+
+    return () => {
+      closed = true;
+      live.current = false;
+      clearTimeout(retry);
+      if (source) source.close();
+    };
+  }, [id, navigate, reloadMarathon, reloadStudents]);
+
+  const handleAdd = async pid => {
+    try {
+      await marathons.addProblem(id, pid);
+      if (!live.current) await reloadMarathon();
     } catch (e) {
       alert(e.response?.data?.message);
     }
@@ -51,9 +121,7 @@ export default function MarathonDetail() {
     if (window.confirm('¿Estás seguro de eliminar este problema de la maratón?')) {
       try {
         await marathons.removeProblem(id, pid);
-        const r = await marathons.getById(id);
-        setAssigned(r.data.problems);
-        setMarathon(r.data.marathon);
+        if (!live.current) await reloadMarathon();
         alert('Problema eliminado de la maratón exitosamente');
       } catch (e) {
         alert(e.response?.data?.message || 'Error al eliminar problema');
@@ -63,11 +131,13 @@ export default function MarathonDetail() {
 
   const handleDeleteMarathon = async () => {
     if (window.confirm('¿Estás seguro de eliminar esta maratón?')) {
+      leaving.current = true;
       try {
         await marathons.delete(id);
         alert('Maratón eliminada exitosamente');
         navigate('/marathons');
       } catch (e) {
+        leaving.current = false;
         alert(e.response?.data?.message || 'Error al eliminar maratón');
       }
     }
@@ -77,9 +147,7 @@ export default function MarathonDetail() {
     if (window.confirm('¿Estás seguro de eliminar este estudiante de la maratón?')) {
       try {
         await marathons.removeStudent(id, studentId);
-        // Actualizar lista de estudiantes
-        const rS = await marathons.getStudents(id);
-        setStudents(rS.data.students);
+        if (!live.current) await reloadStudents();
         alert('Estudiante eliminado exitosamente');
       } catch (e) {
         alert(e.response?.data?.message || 'Error al eliminar estudiante');
@@ -47,6 +47,14 @@ export const marathons = {
   getMyMarathons:  ()                        => api.get('/my-marathons'),
   getStudents:     id                        => api.get(`/marathons/${id}/students`),
   removeStudent:   (mid, uid)                => api.delete(`/marathons/${mid}/students/${uid}`),
+  // EventSource no envía cabeceras: se pide un ticket de un solo uso y se
+  // pasa en la query (el JWT nunca va en la URL)
+  events: async (id, lastEventId) => {
+    const { data } = await api.post(`/marathons/${id}/events/ticket`);
+    const since = lastEventId ? `&last_event_id=${encodeURIComponent(lastEventId)}` : '';
+    return new EventSource(
+      `${API_BASE_URL}/marathons/${id}/events?ticket=${encodeURIComponent(data.ticket)}${since}`);
+  },
 };
 
 // Endpoints de Problemas
@@ -65,6 +73,9 @@ export const users = {
   deleteUser:   id           => api.delete(`/users/${id}`),
 };
 
+// Varias peticiones en un solo viaje: [{ id, method, path, body }]
+export const batch = requests => api.post('/batch', { requests });
+
 // Health check
 export const health = {
   check: () => api.get('/health'),
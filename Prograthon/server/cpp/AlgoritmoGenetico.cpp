@@ -1,15 +1,33 @@
 #include "AlgoritmoGenetico.h"
 #include <algorithm>
+#include <chrono>
 #include <numeric>
 #include <ctime>
 #include <iostream>
+#include <unordered_set>
+
+// Entradas máximas de la memo de fitness por ejecución
+static const size_t MAX_MEMO = 1 << 16;
 
 AlgoritmoGenetico::AlgoritmoGenetico(const std::vector<Problema>& problemas, 
                                    int totalObj, 
                                    int tamPoblacion, 
                                    int maxGen) 
-    : datos(problemas), totalProblemas(totalObj), popSize(tamPoblacion), 
-      maxGeneraciones(maxGen), gen(std::time(nullptr)), dis(0.0, 1.0) {
+    : AlgoritmoGenetico(std::make_shared<const std::vector<Problema>>(problemas),
+                        totalObj, tamPoblacion, maxGen,
+                        static_cast<unsigned int>(std::time(nullptr))) {
+}
+
+AlgoritmoGenetico::AlgoritmoGenetico(std::shared_ptr<const std::vector<Problema>> problemas,
+                                   int totalObj,
+                                   int tamPoblacion,
+                                   int maxGen,
+                                   unsigned int semilla)
+    : banco(std::move(problemas)), datos(*banco), totalProblemas(totalObj), popSize(tamPoblacion),
+      maxGeneraciones(maxGen), gen(semilla), dis(0.0, 1.0),
+      tabla(banco->size(),
+            std::min(MAX_MEMO, static_cast<size_t>(std::max(1, tamPoblacion)) * (std::max(0, maxGen) + 1)),
+            semilla) {
     
     if (totalProblemas > static_cast<int>(datos.size())) {
         totalProblemas = static_cast<int>(datos.size());
@@ -17,6 +35,14 @@ AlgoritmoGenetico::AlgoritmoGenetico(const std::vector<Problema>& problemas,
 }
 
 double AlgoritmoGenetico::fitness(const std::vector<int>& individuo) {
+    // La selección por ruleta repite individuos: se evalúan una sola vez
+    uint64_t h = tabla.hash(individuo.begin(), individuo.end());
+    double memo;
+    if (tabla.buscar(h, memo)) {
+        return memo;
+    }
+
+    ++evaluaciones;
     double tiempoTotal = 0.0;
     for (int idx : individuo) {
         if (idx >= 0 && idx < static_cast<int>(datos.size())) {
@@ -26,7 +52,9 @@ double AlgoritmoGenetico::fitness(const std::vector<int>& individuo) {
     
     // Función de fitness: 1 / (1 + tiempo_total)
     // Mientras menor sea el tiempo, mayor será el fitness
-    return 1.0 / (1.0 + tiempoTotal);
+    double f = 1.0 / (1.0 + tiempoTotal);
+    tabla.guardar(h, f);
+    return f;
 }
 
 std::vector<int> AlgoritmoGenetico::crearIndividuo() {
@@ -39,6 +67,27 @@ std::vector<int> AlgoritmoGenetico::crearIndividuo() {
     return individuo;
 }
 
+void AlgoritmoGenetico::eliminarClones(std::vector<std::vector<int>>& poblacion) {
+    // Cada clon se reemplaza por una variante a un gen de distancia: conserva
+    // casi todo el material seleccionado y es mucho más barato que crear un
+    // individuo nuevo barajando el banco completo.
+    if (totalProblemas <= 0 || static_cast<int>(datos.size()) <= totalProblemas) return;
+    std::uniform_int_distribution<int> posicion(0, totalProblemas - 1);
+    std::uniform_int_distribution<int> problema(0, static_cast<int>(datos.size()) - 1);
+
+    std::unordered_set<uint64_t> vistos;
+    vistos.reserve(poblacion.size());
+    for (auto& individuo : poblacion) {
+        for (int intento = 0; intento < 8; ++intento) {
+            if (vistos.insert(tabla.hash(individuo.begin(), individuo.end())).second) break;
+            int nuevo = problema(gen);
+            if (std::find(individuo.begin(), individuo.end(), nuevo) == individuo.end()) {
+                individuo[posicion(gen)] = nuevo;
+            }
+        }
+    }
+}
+
 std::vector<std::vector<int>> AlgoritmoGenetico::crearPoblacion() {
     std::vector<std::vector<int>> poblacion;
     poblacion.reserve(popSize);
@@ -128,6 +177,8 @@ std::vector<Problema> AlgoritmoGenetico::ejecutar() {
     }
     
     auto poblacion = crearPoblacion();
+    auto inicio = std::chrono::steady_clock::now();
+    std::vector<uint64_t> huellas;
     
     for (int generacion = 0; generacion < maxGeneraciones; ++generacion) {
         // Calcular fitness de toda la población
@@ -137,9 +188,23 @@ std::vector<Problema> AlgoritmoGenetico::ejecutar() {
         for (const auto& individuo : poblacion) {
             fitnesses.push_back(fitness(individuo));
         }
+
+        if (canal) {
+            if (canal->cancelado()) break;
+            huellas.clear();
+            for (const auto& individuo : poblacion) {
+                huellas.push_back(telemetria::huella(individuo.begin(), individuo.end()));
+            }
+            canal->publicar(telemetria::resumir(generacion, fitnesses, huellas, inicio));
+        }
         
         // Selección
         poblacion = seleccion(poblacion, fitnesses);
+
+        // Eliminar clones (mismo conjunto de problemas) antes de cruzar
+        if (deduplicar) {
+            eliminarClones(poblacion);
+        }
         
         // Cruza y mutación
         std::vector<std::vector<int>> nuevaPoblacion;
@@ -168,12 +233,27 @@ std::vector<Problema> AlgoritmoGenetico::ejecutar() {
     
     auto mejorIt = std::max_element(fitnesses.begin(), fitnesses.end());
     int mejorIdx = std::distance(fitnesses.begin(), mejorIt);
+    std::vector<int> mejor = poblacion[mejorIdx];
+
+    // Etapa memética opcional sobre los mejores individuos
+    if (refinamiento.activo()) {
+        std::vector<int> tiempos;
+        tiempos.reserve(datos.size());
+        for (const auto& p : datos) tiempos.push_back(p.tiempoPromedio);
+
+        std::vector<std::vector<uint32_t>> candidatos;
+        for (size_t i : indicesMejores(fitnesses, refinamiento.topK)) {
+            candidatos.emplace_back(poblacion[i].begin(), poblacion[i].end());
+        }
+        auto refinado = refinarMejores(std::move(candidatos), tiempos, refinamiento, gen(), &evaluaciones);
+        mejor.assign(refinado.begin(), refinado.end());
+    }
     
     // Convertir índices a problemas
     std::vector<Problema> resultado;
     resultado.reserve(totalProblemas);
     
-    for (int idx : poblacion[mejorIdx]) {
+    for (int idx : mejor) {
         if (idx >= 0 && idx < static_cast<int>(datos.size())) {
             resultado.push_back(datos[idx]);
         }
@@ -4,26 +4,40 @@
 #include <vector>
 #include <string>
 #include <random>
+#include <memory>
+#include <bsoncxx/oid.hpp>
+#include "TablaFitness.h"
+#include "BusquedaLocal.h"
+#include "Telemetria.h"
 
+// Solo lo que necesita el algoritmo: el _id se guarda como los 12 bytes del
+// ObjectId (sin pasar por hexadecimal) y el nombre no se lee de la BD.
 struct Problema {
-    std::string id;
-    std::string nombre;
+    bsoncxx::oid id;
     int tiempoPromedio;
     int dificultad;
 };
 
 class AlgoritmoGenetico {
 private:
-    std::vector<Problema> datos;
+    // Banco inmutable; varias ejecuciones en paralelo pueden compartirlo
+    std::shared_ptr<const std::vector<Problema>> banco;
+    const std::vector<Problema>& datos;
     int totalProblemas;
     int popSize;
     int maxGeneraciones;
     std::mt19937 gen;
     std::uniform_real_distribution<> dis;
+    TablaFitness tabla; // memo de fitness de esta ejecución
+    bool deduplicar = false;
+    Refinamiento refinamiento;
+    CanalTelemetria* canal = nullptr;
+    int64_t evaluaciones = 0; // fitness calculados (sin aciertos de la memo) y pasos de búsqueda local
     
     // Métodos privados
     double fitness(const std::vector<int>& individuo);
     std::vector<int> crearIndividuo();
+    void eliminarClones(std::vector<std::vector<int>>& poblacion);
     std::vector<std::vector<int>> crearPoblacion();
     std::vector<std::vector<int>> seleccion(const std::vector<std::vector<int>>& poblacion, 
                                            const std::vector<double>& fitnesses);
@@ -35,8 +49,25 @@ public:
                      int totalObj, 
                      int tamPoblacion = 50, 
                      int maxGen = 100);
+
+    // Versión sin copia del banco y con semilla explícita (ejecuciones en lote)
+    AlgoritmoGenetico(std::shared_ptr<const std::vector<Problema>> problemas,
+                     int totalObj,
+                     int tamPoblacion,
+                     int maxGen,
+                     unsigned int semilla);
     
+    // Tras cada selección, cada clon cambia un gen al azar (hasta 8 intentos)
+    // para quedar a un gen de distancia del original.
+    void setDeduplicar(bool activo) { deduplicar = activo; }
+    // Búsqueda local sobre los mejores individuos finales (ver BusquedaLocal.h).
+    void setRefinamiento(const Refinamiento& config) { refinamiento = config; }
+    // Publica un resumen por generación; si el canal se cancela, termina
+    // antes con la mejor solución alcanzada.
+    void setTelemetria(CanalTelemetria* c) { canal = c; }
+
     std::vector<Problema> ejecutar();
+    int64_t evaluacionesRealizadas() const { return evaluaciones; }
 };
 
 #endif // ALGORITMO_GENETICO_H
\ No newline at end of file
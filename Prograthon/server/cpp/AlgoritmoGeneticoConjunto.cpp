@@ -0,0 +1,244 @@
+#include "AlgoritmoGeneticoConjunto.h"
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+namespace {
+inline int popcount64(uint64_t x) { return __builtin_popcountll(x); }
+inline int ctz64(uint64_t x) { return __builtin_ctzll(x); }
+
+inline bool bit(const std::vector<uint64_t>& b, size_t i) {
+    return (b[i >> 6] >> (i & 63)) & 1;
+}
+inline void setBit(std::vector<uint64_t>& b, size_t i) { b[i >> 6] |= uint64_t{1} << (i & 63); }
+inline void clearBit(std::vector<uint64_t>& b, size_t i) { b[i >> 6] &= ~(uint64_t{1} << (i & 63)); }
+
+// Recorre los índices de los bits encendidos de una palabra
+template<typename F>
+inline void forEachBit(uint64_t w, size_t base, F&& f) {
+    while (w) {
+        f(base + ctz64(w));
+        w &= w - 1;
+    }
+}
+}
+
+AlgoritmoGeneticoConjunto::AlgoritmoGeneticoConjunto(
+    std::shared_ptr<const std::vector<Problema>> problemas,
+    int totalObj,
+    int tamPoblacion,
+    int maxGen,
+    unsigned int semilla)
+    : banco(std::move(problemas)), datos(*banco), totalProblemas(totalObj),
+      popSize(tamPoblacion), maxGeneraciones(maxGen),
+      palabras((banco->size() + 63) / 64), gen(semilla), dis(0.0, 1.0) {
+
+    if (totalProblemas > static_cast<int>(datos.size())) {
+        totalProblemas = static_cast<int>(datos.size());
+    }
+}
+
+double AlgoritmoGeneticoConjunto::fitness(const Individuo& individuo) {
+    ++evaluaciones;
+    // Suma de tiempos sobre los bits encendidos: O(palabras + totalProblemas)
+    double tiempoTotal = 0.0;
+    for (size_t w = 0; w < palabras; ++w) {
+        forEachBit(individuo[w], w * 64, [&](size_t i) {
+            tiempoTotal += datos[i].tiempoPromedio;
+        });
+    }
+
+    // Misma función que la codificación por permutación: 1 / (1 + tiempo_total)
+    return 1.0 / (1.0 + tiempoTotal);
+}
+
+AlgoritmoGeneticoConjunto::Individuo AlgoritmoGeneticoConjunto::crearIndividuo() {
+    // Muestreo de Floyd: totalProblemas índices distintos sin barajar el banco
+    Individuo individuo(palabras, 0);
+    int n = static_cast<int>(datos.size());
+    for (int j = n - totalProblemas; j < n; ++j) {
+        int t = std::uniform_int_distribution<int>(0, j)(gen);
+        if (bit(individuo, t)) setBit(individuo, j);
+        else setBit(individuo, t);
+    }
+    return individuo;
+}
+
+std::vector<AlgoritmoGeneticoConjunto::Individuo> AlgoritmoGeneticoConjunto::seleccion(
+    const std::vector<Individuo>& poblacion,
+    const std::vector<double>& fitnesses) {
+
+    std::vector<Individuo> seleccionados;
+    seleccionados.reserve(popSize);
+
+    // Selección por ruleta
+    double sumFitness = std::accumulate(fitnesses.begin(), fitnesses.end(), 0.0);
+
+    for (int i = 0; i < popSize; ++i) {
+        double r = dis(gen) * sumFitness;
+        double suma = 0.0;
+
+        for (size_t j = 0; j < poblacion.size(); ++j) {
+            suma += fitnesses[j];
+            if (suma >= r) {
+                seleccionados.push_back(poblacion[j]);
+                break;
+            }
+        }
+    }
+
+    return seleccionados;
+}
+
+AlgoritmoGeneticoConjunto::Individuo AlgoritmoGeneticoConjunto::cruza(const Individuo& p1,
+                                                                      const Individuo& p2) {
+    // El hijo hereda los problemas comunes y completa con una muestra de los
+    // que solo tiene uno de los padres, hasta volver a totalProblemas.
+    Individuo hijo(palabras);
+    std::vector<size_t> distintos;
+    int comunes = 0;
+    for (size_t w = 0; w < palabras; ++w) {
+        hijo[w] = p1[w] & p2[w];
+        comunes += popcount64(hijo[w]);
+        forEachBit(p1[w] ^ p2[w], w * 64, [&](size_t i) { distintos.push_back(i); });
+    }
+
+    size_t faltan = static_cast<size_t>(totalProblemas - comunes);
+    for (size_t k = 0; k < faltan && k < distintos.size(); ++k) {
+        size_t j = std::uniform_int_distribution<size_t>(k, distintos.size() - 1)(gen);
+        std::swap(distintos[k], distintos[j]);
+        setBit(hijo, distintos[k]);
+    }
+    return hijo;
+}
+
+void AlgoritmoGeneticoConjunto::mutacion(Individuo& individuo) {
+    int n = static_cast<int>(datos.size());
+    if (totalProblemas == 0 || totalProblemas >= n || dis(gen) >= 0.1) { // 10% probabilidad de mutación
+        return;
+    }
+
+    // Quitar el r-ésimo problema elegido
+    int r = std::uniform_int_distribution<int>(0, totalProblemas - 1)(gen);
+    for (size_t w = 0; w < palabras; ++w) {
+        int c = popcount64(individuo[w]);
+        if (r < c) {
+            uint64_t x = individuo[w];
+            for (int k = 0; k < r; ++k) x &= x - 1;
+            clearBit(individuo, w * 64 + ctz64(x));
+            break;
+        }
+        r -= c;
+    }
+
+    // Poner uno libre al azar (distinto del quitado no hace falta: el
+    // individuo conserva totalProblemas bits en cualquier caso)
+    for (;;) {
+        int libre = std::uniform_int_distribution<int>(0, n - 1)(gen);
+        if (!bit(individuo, libre)) {
+            setBit(individuo, libre);
+            return;
+        }
+    }
+}
+
+std::vector<Problema> AlgoritmoGeneticoConjunto::ejecutar() {
+    if (datos.empty() || totalProblemas <= 0) {
+        return {};
+    }
+
+    std::vector<Individuo> poblacion;
+    poblacion.reserve(popSize);
+    for (int i = 0; i < popSize; ++i) {
+        poblacion.push_back(crearIndividuo());
+    }
+
+    auto inicio = std::chrono::steady_clock::now();
+    std::vector<uint64_t> huellas;
+    std::vector<double> fitnesses(poblacion.size());
+    for (int generacion = 0; generacion < maxGeneraciones; ++generacion) {
+        fitnesses.resize(poblacion.size());
+        for (size_t i = 0; i < poblacion.size(); ++i) {
+            fitnesses[i] = fitness(poblacion[i]);
+        }
+
+        if (canal) {
+            if (canal->cancelado()) break;
+            huellas.clear();
+            for (const auto& individuo : poblacion) {
+                uint64_t h = 0;
+                for (size_t w = 0; w < palabras; ++w) {
+                    forEachBit(individuo[w], w * 64, [&](size_t b) { h += telemetria::mezclar(b); });
+                }
+                huellas.push_back(h);
+            }
+            canal->publicar(telemetria::resumir(generacion, fitnesses, huellas, inicio));
+        }
+
+        poblacion = seleccion(poblacion, fitnesses);
+
+        std::vector<Individuo> nuevaPoblacion;
+        nuevaPoblacion.reserve(popSize);
+        for (size_t i = 0; i < poblacion.size(); i += 2) {
+            if (i + 1 < poblacion.size()) {
+                nuevaPoblacion.push_back(cruza(poblacion[i], poblacion[i + 1]));
+                nuevaPoblacion.push_back(cruza(poblacion[i + 1], poblacion[i]));
+                mutacion(nuevaPoblacion[nuevaPoblacion.size() - 2]);
+                mutacion(nuevaPoblacion.back());
+            } else {
+                nuevaPoblacion.push_back(poblacion[i]);
+                mutacion(nuevaPoblacion.back());
+            }
+        }
+        poblacion = std::move(nuevaPoblacion);
+    }
+
+    // Encontrar el mejor individuo
+    fitnesses.resize(poblacion.size());
+    size_t mejor = 0;
+    double mejorFitness = -1.0;
+    for (size_t i = 0; i < poblacion.size(); ++i) {
+        fitnesses[i] = fitness(poblacion[i]);
+        if (fitnesses[i] > mejorFitness) {
+            mejorFitness = fitnesses[i];
+            mejor = i;
+        }
+    }
+
+    if (refinamiento.activo()) {
+        // La búsqueda local trabaja con listas de índices; se vuelve al bitset
+        std::vector<int> tiempos;
+        tiempos.reserve(datos.size());
+        for (const auto& p : datos) tiempos.push_back(p.tiempoPromedio);
+
+        std::vector<std::vector<uint32_t>> candidatos;
+        for (size_t i : indicesMejores(fitnesses, refinamiento.topK)) {
+            std::vector<uint32_t> indices;
+            indices.reserve(totalProblemas);
+            for (size_t w = 0; w < palabras; ++w) {
+                forEachBit(poblacion[i][w], w * 64,
+                           [&](size_t b) { indices.push_back(static_cast<uint32_t>(b)); });
+            }
+            candidatos.push_back(std::move(indices));
+        }
+        Individuo refinado(palabras, 0);
+        for (uint32_t b : refinarMejores(std::move(candidatos), tiempos, refinamiento, gen(), &evaluaciones)) {
+            refinado[b / 64] |= uint64_t{1} << (b % 64);
+        }
+        return aProblemas(refinado);
+    }
+    return aProblemas(poblacion[mejor]);
+}
+
+std::vector<Problema> AlgoritmoGeneticoConjunto::aProblemas(const Individuo& individuo) const {
+    std::vector<Problema> resultado;
+    resultado.reserve(totalProblemas);
+    for (size_t w = 0; w < palabras; ++w) {
+        forEachBit(individuo[w], w * 64, [&](size_t i) { resultado.push_back(datos[i]); });
+    }
+    std::stable_sort(resultado.begin(), resultado.end(), [](const Problema& a, const Problema& b) {
+        if (a.dificultad != b.dificultad) return a.dificultad < b.dificultad;
+        return a.tiempoPromedio < b.tiempoPromedio;
+    });
+    return resultado;
+}
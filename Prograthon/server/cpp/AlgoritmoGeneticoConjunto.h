@@ -0,0 +1,59 @@
+#ifndef ALGORITMO_GENETICO_CONJUNTO_H
+#define ALGORITMO_GENETICO_CONJUNTO_H
+
+#include "AlgoritmoGenetico.h"
+#include "BusquedaLocal.h"
+#include "Telemetria.h"
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Variante del algoritmo genético con codificación de conjunto.
+// El fitness solo depende de qué problemas se eligen, no del orden, así que
+// cada individuo es un bitset sobre el banco con exactamente totalProblemas
+// bits encendidos. La cruza conserva esa cantidad (popcount) y la mutación
+// intercambia un problema elegido por uno libre.
+class AlgoritmoGeneticoConjunto {
+private:
+    using Individuo = std::vector<uint64_t>;
+
+    std::shared_ptr<const std::vector<Problema>> banco;
+    const std::vector<Problema>& datos;
+    int totalProblemas;
+    int popSize;
+    int maxGeneraciones;
+    size_t palabras; // uint64_t por individuo
+    std::mt19937 gen;
+    std::uniform_real_distribution<> dis;
+    Refinamiento refinamiento;
+    CanalTelemetria* canal = nullptr;
+    int64_t evaluaciones = 0; // fitness calculados y pasos de búsqueda local
+
+    double fitness(const Individuo& individuo);
+    Individuo crearIndividuo();
+    std::vector<Individuo> seleccion(const std::vector<Individuo>& poblacion,
+                                     const std::vector<double>& fitnesses);
+    Individuo cruza(const Individuo& p1, const Individuo& p2);
+    void mutacion(Individuo& individuo);
+
+public:
+    AlgoritmoGeneticoConjunto(std::shared_ptr<const std::vector<Problema>> problemas,
+                              int totalObj,
+                              int tamPoblacion,
+                              int maxGen,
+                              unsigned int semilla);
+
+    // Búsqueda local sobre los mejores individuos finales (ver BusquedaLocal.h).
+    void setRefinamiento(const Refinamiento& config) { refinamiento = config; }
+    // Igual que AlgoritmoGenetico::setTelemetria.
+    void setTelemetria(CanalTelemetria* c) { canal = c; }
+
+    std::vector<Problema> ejecutar();
+    int64_t evaluacionesRealizadas() const { return evaluaciones; }
+
+    // Problemas del conjunto ordenados para presentarlos (de fácil a difícil).
+    std::vector<Problema> aProblemas(const Individuo& individuo) const;
+};
+
+#endif // ALGORITMO_GENETICO_CONJUNTO_H
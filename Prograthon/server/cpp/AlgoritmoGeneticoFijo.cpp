@@ -0,0 +1,55 @@
+#include "AlgoritmoGeneticoFijo.h"
+#include <utility>
+
+namespace {
+template<int K>
+std::vector<Problema> ejecutarFijo(std::shared_ptr<const std::vector<Problema>> problemas,
+                                   int tamPoblacion, int maxGen, unsigned int semilla,
+                                   bool deduplicar, const Refinamiento& refinamiento,
+                                   CanalTelemetria* canal, int64_t* evaluaciones) {
+    AlgoritmoGeneticoFijo<K> ag(std::move(problemas), tamPoblacion, maxGen, semilla,
+                                deduplicar, refinamiento);
+    ag.setTelemetria(canal);
+    auto resultado = ag.ejecutar();
+    if (evaluaciones) *evaluaciones = ag.evaluacionesRealizadas();
+    return resultado;
+}
+
+// Tabla de instancias K = MIN..MIN+N-1
+constexpr int K_MIN = 5;
+constexpr int K_MAX = 16;
+
+using Ejecutor = std::vector<Problema> (*)(std::shared_ptr<const std::vector<Problema>>,
+                                           int, int, unsigned int, bool, const Refinamiento&,
+                                           CanalTelemetria*, int64_t*);
+
+template<int... Is>
+constexpr std::array<Ejecutor, sizeof...(Is)> tabla(std::integer_sequence<int, Is...>) {
+    return {&ejecutarFijo<K_MIN + Is>...};
+}
+
+constexpr auto EJECUTORES = tabla(std::make_integer_sequence<int, K_MAX - K_MIN + 1>{});
+}
+
+std::vector<Problema> ejecutarPermutacion(std::shared_ptr<const std::vector<Problema>> problemas,
+                                          int totalObj,
+                                          int tamPoblacion,
+                                          int maxGen,
+                                          unsigned int semilla,
+                                          bool deduplicar,
+                                          const Refinamiento& refinamiento,
+                                          CanalTelemetria* canal,
+                                          int64_t* evaluaciones) {
+    if (totalObj >= K_MIN && totalObj <= K_MAX &&
+        problemas->size() >= static_cast<size_t>(totalObj) && tamPoblacion > 0) {
+        return EJECUTORES[totalObj - K_MIN](std::move(problemas), tamPoblacion, maxGen, semilla,
+                                              deduplicar, refinamiento, canal, evaluaciones);
+    }
+    AlgoritmoGenetico ag(std::move(problemas), totalObj, tamPoblacion, maxGen, semilla);
+    ag.setDeduplicar(deduplicar);
+    ag.setRefinamiento(refinamiento);
+    ag.setTelemetria(canal);
+    auto resultado = ag.ejecutar();
+    if (evaluaciones) *evaluaciones = ag.evaluacionesRealizadas();
+    return resultado;
+}
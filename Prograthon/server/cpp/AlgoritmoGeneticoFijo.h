@@ -0,0 +1,215 @@
+#ifndef ALGORITMO_GENETICO_FIJO_H
+#define ALGORITMO_GENETICO_FIJO_H
+
+#include "AlgoritmoGenetico.h"
+#include "TablaFitness.h"
+#include "BusquedaLocal.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+// Mismo algoritmo que AlgoritmoGenetico (permutación + cruza de orden), pero
+// con el tamaño de la maratón K fijo en tiempo de compilación. Cada individuo
+// es un std::array<uint32_t, K> contiguo en memoria y todos los bucles sobre
+// el genoma tienen longitud constante, así el compilador los desenrolla.
+template<int K>
+class AlgoritmoGeneticoFijo {
+    static_assert(K > 0, "K debe ser positivo");
+
+public:
+    using Individuo = std::array<uint32_t, K>;
+
+    AlgoritmoGeneticoFijo(std::shared_ptr<const std::vector<Problema>> problemas,
+                          int tamPoblacion,
+                          int maxGen,
+                          unsigned int semilla,
+                          bool deduplicar = false,
+                          const Refinamiento& refinamiento = {})
+        : banco(std::move(problemas)), popSize(tamPoblacion),
+          maxGeneraciones(maxGen), deduplicar(deduplicar), refinamiento(refinamiento),
+          gen(semilla), dis(0.0, 1.0),
+          tabla(deduplicar ? banco->size() : 0, 0, semilla) {
+        // Tiempos contiguos: el fitness solo lee este arreglo
+        tiempos.reserve(banco->size());
+        for (const auto& p : *banco) tiempos.push_back(p.tiempoPromedio);
+    }
+
+    // Igual que AlgoritmoGenetico::setTelemetria.
+    void setTelemetria(CanalTelemetria* c) { canal = c; }
+
+    std::vector<Problema> ejecutar() {
+        if (banco->size() < static_cast<size_t>(K)) return {};
+
+        std::vector<Individuo> poblacion(popSize);
+        for (auto& ind : poblacion) ind = crearIndividuo();
+
+        auto inicio = std::chrono::steady_clock::now();
+        std::vector<uint64_t> huellas;
+        std::vector<double> fitnesses(popSize);
+        std::vector<Individuo> seleccionados(popSize);
+        for (int generacion = 0; generacion < maxGeneraciones; ++generacion) {
+            for (int i = 0; i < popSize; ++i) fitnesses[i] = fitness(poblacion[i]);
+
+            if (canal) {
+                if (canal->cancelado()) break;
+                huellas.clear();
+                for (const auto& ind : poblacion) huellas.push_back(telemetria::huella(ind.begin(), ind.end()));
+                canal->publicar(telemetria::resumir(generacion, fitnesses, huellas, inicio));
+            }
+
+            seleccion(poblacion, fitnesses, seleccionados);
+            if (deduplicar) eliminarClones(seleccionados);
+
+            for (int i = 0; i + 1 < popSize; i += 2) {
+                poblacion[i]     = mutacion(cruza(seleccionados[i], seleccionados[i + 1]));
+                poblacion[i + 1] = mutacion(cruza(seleccionados[i + 1], seleccionados[i]));
+            }
+            if (popSize % 2) poblacion[popSize - 1] = mutacion(seleccionados[popSize - 1]);
+        }
+
+        int mejor = 0;
+        double mejorFitness = -1.0;
+        for (int i = 0; i < popSize; ++i) {
+            fitnesses[i] = fitness(poblacion[i]);
+            if (fitnesses[i] > mejorFitness) { mejorFitness = fitnesses[i]; mejor = i; }
+        }
+
+        std::vector<Problema> resultado;
+        resultado.reserve(K);
+        if (refinamiento.activo()) {
+            std::vector<std::vector<uint32_t>> candidatos;
+            for (size_t i : indicesMejores(fitnesses, refinamiento.topK)) {
+                candidatos.emplace_back(poblacion[i].begin(), poblacion[i].end());
+            }
+            for (uint32_t idx : refinarMejores(std::move(candidatos), tiempos, refinamiento, gen(), &evaluaciones)) {
+                resultado.push_back((*banco)[idx]);
+            }
+            return resultado;
+        }
+        for (uint32_t idx : poblacion[mejor]) resultado.push_back((*banco)[idx]);
+        return resultado;
+    }
+
+    int64_t evaluacionesRealizadas() const { return evaluaciones; }
+
+private:
+    double fitness(const Individuo& ind) {
+        ++evaluaciones;
+        int64_t tiempoTotal = 0;
+        for (int i = 0; i < K; ++i) tiempoTotal += tiempos[ind[i]];
+        return 1.0 / (1.0 + static_cast<double>(tiempoTotal));
+    }
+
+    static bool contiene(const Individuo& ind, int n, uint32_t v) {
+        for (int i = 0; i < n; ++i) {
+            if (ind[i] == v) return true;
+        }
+        return false;
+    }
+
+    Individuo crearIndividuo() {
+        // Muestreo de Floyd + barajado: K índices distintos sin copiar el banco
+        Individuo ind{};
+        uint32_t n = static_cast<uint32_t>(banco->size());
+        int k = 0;
+        for (uint32_t j = n - K; j < n; ++j, ++k) {
+            uint32_t t = std::uniform_int_distribution<uint32_t>(0, j)(gen);
+            ind[k] = contiene(ind, k, t) ? j : t;
+        }
+        std::shuffle(ind.begin(), ind.end(), gen);
+        return ind;
+    }
+
+    void seleccion(const std::vector<Individuo>& poblacion,
+                   const std::vector<double>& fitnesses,
+                   std::vector<Individuo>& seleccionados) {
+        // Selección por ruleta
+        double sumFitness = std::accumulate(fitnesses.begin(), fitnesses.end(), 0.0);
+        for (int i = 0; i < popSize; ++i) {
+            double r = dis(gen) * sumFitness;
+            double suma = 0.0;
+            int elegido = popSize - 1;
+            for (int j = 0; j < popSize; ++j) {
+                suma += fitnesses[j];
+                if (suma >= r) { elegido = j; break; }
+            }
+            seleccionados[i] = poblacion[elegido];
+        }
+    }
+
+    // Aquí el fitness cuesta K sumas, así que la tabla solo se usa para el
+    // hash de Zobrist, no como memo. Igual que en AlgoritmoGenetico, cada clon
+    // pasa a estar a un gen de distancia del original.
+    void eliminarClones(std::vector<Individuo>& seleccionados) {
+        uint32_t n = static_cast<uint32_t>(banco->size());
+        if (n <= static_cast<uint32_t>(K)) return;
+        std::unordered_set<uint64_t> vistos;
+        vistos.reserve(seleccionados.size());
+        for (auto& ind : seleccionados) {
+            for (int intento = 0; intento < 8; ++intento) {
+                if (vistos.insert(tabla.hash(ind.begin(), ind.end())).second) break;
+                uint32_t nuevo = std::uniform_int_distribution<uint32_t>(0, n - 1)(gen);
+                if (!contiene(ind, K, nuevo)) {
+                    ind[std::uniform_int_distribution<int>(0, K - 1)(gen)] = nuevo;
+                }
+            }
+        }
+    }
+
+    Individuo cruza(const Individuo& p1, const Individuo& p2) {
+        // Cruza de orden (OX): segmento de p1 y el resto en el orden de p2.
+        // p2 tiene K elementos distintos, así que siempre alcanza para completar.
+        int inicio = std::uniform_int_distribution<int>(0, K - 1)(gen);
+        int fin = std::uniform_int_distribution<int>(inicio, K - 1)(gen);
+
+        Individuo hijo{};
+        int n = 0;
+        for (int i = inicio; i <= fin; ++i) hijo[n++] = p1[i];
+        for (int i = 0; i < K && n < K; ++i) {
+            if (!contiene(hijo, n, p2[i])) hijo[n++] = p2[i];
+        }
+        return hijo;
+    }
+
+    Individuo mutacion(Individuo ind) {
+        if (K > 1 && dis(gen) < 0.1) { // 10% probabilidad de mutación
+            int i = std::uniform_int_distribution<int>(0, K - 1)(gen);
+            int j = std::uniform_int_distribution<int>(0, K - 1)(gen);
+            std::swap(ind[i], ind[j]);
+        }
+        return ind;
+    }
+
+    std::shared_ptr<const std::vector<Problema>> banco;
+    std::vector<int32_t> tiempos;
+    int popSize;
+    int maxGeneraciones;
+    bool deduplicar;
+    Refinamiento refinamiento;
+    CanalTelemetria* canal = nullptr;
+    std::mt19937 gen;
+    std::uniform_real_distribution<> dis;
+    TablaFitness tabla;
+    int64_t evaluaciones = 0;
+};
+
+// Usa la versión especializada para 5 <= K <= 16 y AlgoritmoGenetico en
+// cualquier otro caso. En `evaluaciones` (opcional) deja los fitness que se
+// calcularon de verdad más los pasos de búsqueda local.
+std::vector<Problema> ejecutarPermutacion(std::shared_ptr<const std::vector<Problema>> problemas,
+                                          int totalObj,
+                                          int tamPoblacion,
+                                          int maxGen,
+                                          unsigned int semilla,
+                                          bool deduplicar = false,
+                                          const Refinamiento& refinamiento = {},
+                                          CanalTelemetria* canal = nullptr,
+                                          int64_t* evaluaciones = nullptr);
+
+#endif // ALGORITMO_GENETICO_FIJO_H
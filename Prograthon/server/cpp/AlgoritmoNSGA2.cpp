@@ -0,0 +1,233 @@
+#include "AlgoritmoNSGA2.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+AlgoritmoNSGA2::AlgoritmoNSGA2(std::shared_ptr<const std::vector<Problema>> problemas,
+                               int totalObj,
+                               int tamPoblacion,
+                               int maxGen,
+                               unsigned int semilla)
+    : banco(std::move(problemas)), datos(*banco), totalProblemas(totalObj),
+      popSize(std::max(tamPoblacion, 2)), maxGeneraciones(maxGen), gen(semilla), dis(0.0, 1.0) {
+    if (totalProblemas > static_cast<int>(datos.size())) {
+        totalProblemas = static_cast<int>(datos.size());
+    }
+}
+
+AlgoritmoNSGA2::Objetivos AlgoritmoNSGA2::evaluar(const Individuo& ind) const {
+    // Sumas enteras: dos maratones con la misma distribución de dificultad
+    // dan exactamente la misma dispersión y no se "dominan" por redondeo.
+    int64_t tiempo = 0, suma = 0, sumaCuadrados = 0;
+    std::vector<int> niveles; // dificultades vistas, sin suponer rango
+    niveles.reserve(ind.size());
+    for (uint32_t idx : ind) {
+        const Problema& p = datos[idx];
+        tiempo += p.tiempoPromedio;
+        suma += p.dificultad;
+        sumaCuadrados += static_cast<int64_t>(p.dificultad) * p.dificultad;
+        niveles.push_back(p.dificultad);
+    }
+    int64_t n = static_cast<int64_t>(ind.size());
+    double dispersion = std::sqrt(static_cast<double>(n * sumaCuadrados - suma * suma)) / static_cast<double>(n);
+    std::sort(niveles.begin(), niveles.end());
+    auto distintos = std::unique(niveles.begin(), niveles.end()) - niveles.begin();
+    return {static_cast<double>(tiempo), -dispersion, -static_cast<double>(distintos)};
+}
+
+AlgoritmoNSGA2::Individuo AlgoritmoNSGA2::crearIndividuo() {
+    // Muestreo de Floyd: totalProblemas índices distintos sin copiar el banco
+    uint32_t n = static_cast<uint32_t>(datos.size());
+    Individuo ind;
+    ind.reserve(totalProblemas);
+    for (uint32_t j = n - totalProblemas; j < n; ++j) {
+        uint32_t t = std::uniform_int_distribution<uint32_t>(0, j)(gen);
+        ind.push_back(std::binary_search(ind.begin(), ind.end(), t) ? j : t);
+        std::inplace_merge(ind.begin(), ind.end() - 1, ind.end());
+    }
+    return ind;
+}
+
+AlgoritmoNSGA2::Individuo AlgoritmoNSGA2::cruza(const Individuo& p1, const Individuo& p2) {
+    // Se conservan los problemas comunes y se completa con una muestra de
+    // la diferencia simétrica, así el hijo mantiene el tamaño.
+    Individuo hijo, resto;
+    std::set_intersection(p1.begin(), p1.end(), p2.begin(), p2.end(), std::back_inserter(hijo));
+    std::set_symmetric_difference(p1.begin(), p1.end(), p2.begin(), p2.end(), std::back_inserter(resto));
+    size_t faltan = static_cast<size_t>(totalProblemas) - hijo.size();
+    for (size_t i = 0; i < faltan; ++i) {
+        size_t j = std::uniform_int_distribution<size_t>(i, resto.size() - 1)(gen);
+        std::swap(resto[i], resto[j]);
+    }
+    hijo.insert(hijo.end(), resto.begin(), resto.begin() + faltan);
+    std::sort(hijo.begin(), hijo.end());
+    return hijo;
+}
+
+void AlgoritmoNSGA2::mutacion(Individuo& ind) {
+    if (dis(gen) >= 0.1 || ind.size() >= datos.size()) return; // 10% probabilidad de mutación
+    std::uniform_int_distribution<uint32_t> problema(0, static_cast<uint32_t>(datos.size()) - 1);
+    uint32_t nuevo;
+    do {
+        nuevo = problema(gen);
+    } while (std::binary_search(ind.begin(), ind.end(), nuevo));
+    ind[std::uniform_int_distribution<size_t>(0, ind.size() - 1)(gen)] = nuevo;
+    std::sort(ind.begin(), ind.end());
+}
+
+const AlgoritmoNSGA2::Evaluado& AlgoritmoNSGA2::torneo(const std::vector<Evaluado>& poblacion) {
+    std::uniform_int_distribution<size_t> pos(0, poblacion.size() - 1);
+    const Evaluado& a = poblacion[pos(gen)];
+    const Evaluado& b = poblacion[pos(gen)];
+    if (a.rango != b.rango) return a.rango < b.rango ? a : b;
+    return a.crowding >= b.crowding ? a : b;
+}
+
+bool AlgoritmoNSGA2::domina(const Objetivos& a, const Objetivos& b) {
+    bool mejorEnAlguno = false;
+    for (int m = 0; m < NUM_OBJETIVOS; ++m) {
+        if (a[m] > b[m]) return false;
+        if (a[m] < b[m]) mejorEnAlguno = true;
+    }
+    return mejorEnAlguno;
+}
+
+std::vector<std::vector<size_t>> AlgoritmoNSGA2::ordenarNoDominados(std::vector<Evaluado>& poblacion) {
+    size_t n = poblacion.size();
+    std::vector<std::vector<size_t>> dominados(n); // a quién domina cada uno
+    std::vector<int> contador(n, 0);               // cuántos lo dominan
+    std::vector<std::vector<size_t>> frentes(1);
+
+    for (size_t p = 0; p < n; ++p) {
+        for (size_t q = p + 1; q < n; ++q) {
+            if (domina(poblacion[p].obj, poblacion[q].obj)) {
+                dominados[p].push_back(q);
+                ++contador[q];
+            } else if (domina(poblacion[q].obj, poblacion[p].obj)) {
+                dominados[q].push_back(p);
+                ++contador[p];
+            }
+        }
+    }
+    for (size_t p = 0; p < n; ++p) {
+        if (contador[p] == 0) {
+            poblacion[p].rango = 0;
+            frentes[0].push_back(p);
+        }
+    }
+    for (size_t f = 0; !frentes[f].empty(); ++f) {
+        std::vector<size_t> siguiente;
+        for (size_t p : frentes[f]) {
+            for (size_t q : dominados[p]) {
+                if (--contador[q] == 0) {
+                    poblacion[q].rango = static_cast<int>(f) + 1;
+                    siguiente.push_back(q);
+                }
+            }
+        }
+        frentes.push_back(std::move(siguiente));
+    }
+    frentes.pop_back(); // el último siempre queda vacío
+
+    for (const auto& frente : frentes) asignarCrowding(poblacion, frente);
+    return frentes;
+}
+
+void AlgoritmoNSGA2::asignarCrowding(std::vector<Evaluado>& poblacion, const std::vector<size_t>& frente) {
+    const double infinito = std::numeric_limits<double>::infinity();
+    for (size_t i : frente) poblacion[i].crowding = 0.0;
+    if (frente.size() <= 2) {
+        for (size_t i : frente) poblacion[i].crowding = infinito;
+        return;
+    }
+    std::vector<size_t> orden = frente;
+    for (int m = 0; m < NUM_OBJETIVOS; ++m) {
+        std::sort(orden.begin(), orden.end(),
+                  [&](size_t a, size_t b) { return poblacion[a].obj[m] < poblacion[b].obj[m]; });
+        double minimo = poblacion[orden.front()].obj[m];
+        double maximo = poblacion[orden.back()].obj[m];
+        poblacion[orden.front()].crowding = infinito;
+        poblacion[orden.back()].crowding = infinito;
+        if (maximo == minimo) continue;
+        for (size_t i = 1; i + 1 < orden.size(); ++i) {
+            poblacion[orden[i]].crowding +=
+                (poblacion[orden[i + 1]].obj[m] - poblacion[orden[i - 1]].obj[m]) / (maximo - minimo);
+        }
+    }
+}
+
+std::vector<SolucionPareto> AlgoritmoNSGA2::ejecutar(size_t maxSoluciones) {
+    if (datos.empty() || totalProblemas <= 0 || maxSoluciones == 0) {
+        return {};
+    }
+
+    std::vector<Evaluado> poblacion(popSize);
+    for (auto& e : poblacion) {
+        e.genes = crearIndividuo();
+        e.obj = evaluar(e.genes);
+    }
+    ordenarNoDominados(poblacion);
+
+    for (int generacion = 0; generacion < maxGeneraciones; ++generacion) {
+        // Hijos por torneo binario (rango, luego crowding)
+        std::vector<Evaluado> combinada = poblacion;
+        combinada.reserve(2 * popSize);
+        for (int i = 0; i < popSize; ++i) {
+            Evaluado hijo;
+            hijo.genes = cruza(torneo(poblacion).genes, torneo(poblacion).genes);
+            mutacion(hijo.genes);
+            hijo.obj = evaluar(hijo.genes);
+            combinada.push_back(std::move(hijo));
+        }
+
+        // Selección ambiental: frentes completos y el último por crowding
+        auto frentes = ordenarNoDominados(combinada);
+        std::vector<Evaluado> siguiente;
+        siguiente.reserve(popSize);
+        for (auto& frente : frentes) {
+            if (siguiente.size() + frente.size() > static_cast<size_t>(popSize)) {
+                std::sort(frente.begin(), frente.end(), [&](size_t a, size_t b) {
+                    return combinada[a].crowding > combinada[b].crowding;
+                });
+                frente.resize(popSize - siguiente.size());
+            }
+            for (size_t i : frente) siguiente.push_back(std::move(combinada[i]));
+            if (siguiente.size() == static_cast<size_t>(popSize)) break;
+        }
+        poblacion = std::move(siguiente);
+        // Rango y crowding relativos a la nueva población para el torneo
+        ordenarNoDominados(poblacion);
+    }
+
+    // Primer frente con un representante por punto del espacio de objetivos
+    // (maratones distintas con los mismos objetivos son la misma alternativa)
+    std::vector<const Evaluado*> frente;
+    for (const auto& e : poblacion) {
+        if (e.rango == 0) frente.push_back(&e);
+    }
+    std::sort(frente.begin(), frente.end(), [](const Evaluado* a, const Evaluado* b) {
+        if (a->obj != b->obj) return a->obj < b->obj;
+        return a->crowding > b->crowding;
+    });
+    frente.erase(std::unique(frente.begin(), frente.end(),
+                             [](const Evaluado* a, const Evaluado* b) { return a->obj == b->obj; }),
+                 frente.end());
+    std::stable_sort(frente.begin(), frente.end(),
+                     [](const Evaluado* a, const Evaluado* b) { return a->crowding > b->crowding; });
+    if (frente.size() > maxSoluciones) frente.resize(maxSoluciones);
+    std::sort(frente.begin(), frente.end(),
+              [](const Evaluado* a, const Evaluado* b) { return a->obj[0] < b->obj[0]; });
+
+    std::vector<SolucionPareto> soluciones;
+    soluciones.reserve(frente.size());
+    for (const Evaluado* e : frente) {
+        SolucionPareto s;
+        for (uint32_t idx : e->genes) s.problemas.push_back(datos[idx]);
+        s.tiempoTotal = static_cast<int64_t>(e->obj[0]);
+        s.dispersion = -e->obj[1];
+        s.niveles = static_cast<int>(-e->obj[2]);
+        soluciones.push_back(std::move(s));
+    }
+    return soluciones;
+}
@@ -0,0 +1,70 @@
+#ifndef ALGORITMO_NSGA2_H
+#define ALGORITMO_NSGA2_H
+
+#include "AlgoritmoGenetico.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Una maratón del frente de Pareto con sus objetivos.
+struct SolucionPareto {
+    std::vector<Problema> problemas;
+    int64_t tiempoTotal = 0;   // minimizar
+    double dispersion = 0.0;   // desviación estándar de la dificultad, maximizar
+    int niveles = 0;           // niveles de dificultad distintos, maximizar
+};
+
+// Modo multiobjetivo (NSGA-II). En lugar de una sola maratón con el mejor
+// fitness escalar, devuelve en una ejecución el conjunto de maratones que no
+// son dominadas en tiempo total, dispersión de dificultad y cobertura de
+// niveles. Usa ordenamiento no dominado rápido, distancia de crowding y
+// torneo binario; los individuos son conjuntos (índices ordenados) y los
+// operadores conservan el tamaño, igual que AlgoritmoGeneticoConjunto.
+class AlgoritmoNSGA2 {
+public:
+    AlgoritmoNSGA2(std::shared_ptr<const std::vector<Problema>> problemas,
+                   int totalObj,
+                   int tamPoblacion,
+                   int maxGen,
+                   unsigned int semilla);
+
+    // Primer frente de la población final, sin repetidos y ordenado por
+    // tiempo total. Si el frente es más grande que maxSoluciones se conservan
+    // las de mayor distancia de crowding (las más diferentes entre sí).
+    std::vector<SolucionPareto> ejecutar(size_t maxSoluciones);
+
+private:
+    static constexpr int NUM_OBJETIVOS = 3;
+    using Individuo = std::vector<uint32_t>; // índices al banco, ordenados
+    using Objetivos = std::array<double, NUM_OBJETIVOS>; // todos a minimizar
+
+    struct Evaluado {
+        Individuo genes;
+        Objetivos obj;
+        int rango = 0;
+        double crowding = 0.0;
+    };
+
+    Objetivos evaluar(const Individuo& ind) const;
+    Individuo crearIndividuo();
+    Individuo cruza(const Individuo& p1, const Individuo& p2);
+    void mutacion(Individuo& ind);
+    const Evaluado& torneo(const std::vector<Evaluado>& poblacion);
+
+    static bool domina(const Objetivos& a, const Objetivos& b);
+    // Asigna rango y crowding; devuelve los frentes (posiciones en poblacion)
+    static std::vector<std::vector<size_t>> ordenarNoDominados(std::vector<Evaluado>& poblacion);
+    static void asignarCrowding(std::vector<Evaluado>& poblacion, const std::vector<size_t>& frente);
+
+    std::shared_ptr<const std::vector<Problema>> banco;
+    const std::vector<Problema>& datos;
+    int totalProblemas;
+    int popSize;
+    int maxGeneraciones;
+    std::mt19937 gen;
+    std::uniform_real_distribution<> dis;
+};
+
+#endif // ALGORITMO_NSGA2_H
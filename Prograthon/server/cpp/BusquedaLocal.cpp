@@ -0,0 +1,95 @@
+#include "BusquedaLocal.h"
+#include <algorithm>
+#include <cstdlib>
+#include <future>
+#include <random>
+
+namespace {
+int leerEntero(const char* nombre, int porDefecto) {
+    const char* valor = std::getenv(nombre);
+    if (!valor || !*valor) return porDefecto;
+    int n = std::atoi(valor);
+    return n >= 0 ? n : porDefecto;
+}
+
+// Devuelve la suma de tiempos final del individuo
+int64_t escalar(std::vector<uint32_t>& ind, const std::vector<int>& tiempos,
+                int maxPasos, unsigned int semilla) {
+    int64_t total = 0;
+    for (uint32_t idx : ind) total += tiempos[idx];
+    if (ind.empty() || tiempos.size() <= ind.size()) return total;
+
+    std::mt19937 gen(semilla);
+    std::uniform_int_distribution<uint32_t> problema(0, static_cast<uint32_t>(tiempos.size()) - 1);
+
+    // Gen más caro: el único que conviene reemplazar
+    auto peor = std::max_element(ind.begin(), ind.end(),
+        [&](uint32_t a, uint32_t b) { return tiempos[a] < tiempos[b]; });
+
+    for (int paso = 0; paso < maxPasos; ++paso) {
+        uint32_t nuevo = problema(gen);
+        int delta = tiempos[nuevo] - tiempos[*peor];
+        if (delta >= 0) continue;
+        if (std::find(ind.begin(), ind.end(), nuevo) != ind.end()) continue;
+
+        *peor = nuevo;
+        total += delta;
+        peor = std::max_element(ind.begin(), ind.end(),
+            [&](uint32_t a, uint32_t b) { return tiempos[a] < tiempos[b]; });
+    }
+    return total;
+}
+}
+
+Refinamiento Refinamiento::fromEnv() {
+    Refinamiento r;
+    r.topK = leerEntero("LOCAL_SEARCH_TOP_K", r.topK);
+    r.maxPasos = leerEntero("LOCAL_SEARCH_STEPS", r.maxPasos);
+    r.topK = std::clamp(r.topK, 0, MAX_TOP_K);
+    r.maxPasos = std::clamp(r.maxPasos, 0, MAX_PASOS);
+    return r;
+}
+
+std::vector<size_t> indicesMejores(const std::vector<double>& fitnesses, int k) {
+    std::vector<size_t> orden(fitnesses.size());
+    for (size_t i = 0; i < orden.size(); ++i) orden[i] = i;
+    size_t n = std::min(orden.size(), static_cast<size_t>(std::max(0, k)));
+    std::partial_sort(orden.begin(), orden.begin() + n, orden.end(),
+                      [&](size_t a, size_t b) { return fitnesses[a] > fitnesses[b]; });
+    orden.resize(n);
+    return orden;
+}
+
+std::vector<uint32_t> refinarMejores(std::vector<std::vector<uint32_t>> candidatos,
+                                     const std::vector<int>& tiempos,
+                                     const Refinamiento& config,
+                                     unsigned int semilla,
+                                     int64_t* evaluaciones) {
+    if (candidatos.empty()) return {};
+    if (evaluaciones) {
+        // escalar recorre maxPasos candidatos salvo que no haya con qué reemplazar
+        for (const auto& ind : candidatos) {
+            if (!ind.empty() && tiempos.size() > ind.size()) *evaluaciones += config.maxPasos;
+        }
+    }
+
+    // Cada individuo tiene su propio generador: el resultado no depende del
+    // orden en que terminan los hilos.
+    std::vector<std::future<int64_t>> tareas;
+    tareas.reserve(candidatos.size());
+    for (size_t i = 1; i < candidatos.size(); ++i) {
+        tareas.push_back(std::async(std::launch::async, escalar, std::ref(candidatos[i]),
+                                    std::cref(tiempos), config.maxPasos,
+                                    semilla + static_cast<unsigned int>(i)));
+    }
+    int64_t mejorTotal = escalar(candidatos[0], tiempos, config.maxPasos, semilla);
+    size_t mejor = 0;
+    for (size_t i = 1; i < candidatos.size(); ++i) {
+        int64_t total = tareas[i - 1].get();
+        if (total < mejorTotal) {
+            mejorTotal = total;
+            mejor = i;
+        }
+    }
+    return std::move(candidatos[mejor]);
+}
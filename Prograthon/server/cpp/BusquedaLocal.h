@@ -0,0 +1,41 @@
+#ifndef BUSQUEDA_LOCAL_H
+#define BUSQUEDA_LOCAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Etapa memética: después de la última generación se refinan los mejores
+// individuos con escalada de colinas por reemplazo. Cada paso propone un
+// problema que no está en el individuo y, si su tiempo es menor, ocupa el
+// lugar del gen de mayor tiempo. El fitness es una suma, así que el cambio se
+// evalúa con la diferencia de los dos tiempos, sin recalcular todo.
+struct Refinamiento {
+    // Cada individuo refinado es un hilo: topK acota los hilos por petición
+    static constexpr int MAX_TOP_K = 16;
+    static constexpr int MAX_PASOS = 10000;
+
+    int topK = 0;       // individuos a refinar (0 = desactivado)
+    int maxPasos = 200; // candidatos propuestos por individuo
+
+    bool activo() const { return topK > 0 && maxPasos > 0; }
+    bool valido() const { return topK >= 0 && topK <= MAX_TOP_K && maxPasos >= 0 && maxPasos <= MAX_PASOS; }
+
+    // LOCAL_SEARCH_TOP_K y LOCAL_SEARCH_STEPS
+    static Refinamiento fromEnv();
+};
+
+// Posiciones de los k mayores fitness, de mejor a peor.
+std::vector<size_t> indicesMejores(const std::vector<double>& fitnesses, int k);
+
+// Refina en paralelo (un hilo por individuo) los candidatos recibidos y
+// devuelve el mejor resultado. Los candidatos son índices al banco y
+// tiempos[i] es el tiempoPromedio del problema i. Determinista para una
+// misma semilla. Si se pasa `evaluaciones`, se le suman los pasos ejecutados.
+std::vector<uint32_t> refinarMejores(std::vector<std::vector<uint32_t>> candidatos,
+                                     const std::vector<int>& tiempos,
+                                     const Refinamiento& config,
+                                     unsigned int semilla,
+                                     int64_t* evaluaciones = nullptr);
+
+#endif // BUSQUEDA_LOCAL_H
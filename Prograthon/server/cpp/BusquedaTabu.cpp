@@ -0,0 +1,83 @@
+#include "BusquedaTabu.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+ResultadoOptimizacion BusquedaTabu::optimizar(std::shared_ptr<const std::vector<Problema>> banco,
+                                              const Objetivo& objetivo,
+                                              unsigned int semilla) const {
+    auto inicio = std::chrono::steady_clock::now();
+    const auto& datos = *banco;
+    uint32_t n = static_cast<uint32_t>(datos.size());
+    int k = std::min(objetivo.totalProblemas, static_cast<int>(n));
+
+    std::mt19937 gen(semilla);
+    std::vector<uint32_t> actual = optimizacion::seleccionAleatoria(n, k, gen);
+    auto transcurrido = [&] {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    };
+    if (actual.empty() || static_cast<uint32_t>(k) == n) {
+        return optimizacion::resultado(datos, actual, 0, transcurrido());
+    }
+
+    std::vector<char> elegido(n, 0);
+    int64_t costo = 0;
+    for (uint32_t idx : actual) {
+        elegido[idx] = 1;
+        costo += datos[idx].tiempoPromedio;
+    }
+    std::vector<uint32_t> mejor = actual;
+    int64_t mejorCosto = costo;
+
+    // Iteración hasta la que cada problema tiene prohibido volver a entrar
+    std::vector<int> tabuHasta(n, -1);
+    int tenencia = config.tenencia > 0 ? config.tenencia : std::max(7, k / 2);
+
+    std::uniform_int_distribution<int> posicion(0, k - 1);
+    std::uniform_int_distribution<uint32_t> problema(0, n - 1);
+
+    int64_t evaluaciones = 0;
+    int sinMejora = 0;
+    for (int it = 0; it < config.iteraciones && sinMejora < config.maxSinMejora; ++it) {
+        int mejorPos = -1;
+        uint32_t mejorNuevo = 0;
+        int mejorDelta = std::numeric_limits<int>::max();
+
+        for (int m = 0; m < config.vecindario; ++m) {
+            uint32_t nuevo = problema(gen);
+            if (elegido[nuevo]) continue;
+            int i = posicion(gen);
+            ++evaluaciones;
+
+            int delta = datos[nuevo].tiempoPromedio - datos[actual[i]].tiempoPromedio;
+            bool aspiracion = costo + delta < mejorCosto;
+            if (tabuHasta[nuevo] >= it && !aspiracion) continue;
+            if (delta < mejorDelta) {
+                mejorDelta = delta;
+                mejorPos = i;
+                mejorNuevo = nuevo;
+            }
+        }
+        if (mejorPos < 0) {
+            ++sinMejora;
+            continue;
+        }
+
+        uint32_t sale = actual[mejorPos];
+        tabuHasta[sale] = it + tenencia;
+        elegido[sale] = 0;
+        elegido[mejorNuevo] = 1;
+        actual[mejorPos] = mejorNuevo;
+        costo += mejorDelta;
+
+        if (costo < mejorCosto) {
+            mejorCosto = costo;
+            mejor = actual;
+            sinMejora = 0;
+        } else {
+            ++sinMejora;
+        }
+    }
+
+    return optimizacion::resultado(datos, mejor, evaluaciones, transcurrido());
+}
@@ -0,0 +1,34 @@
+#ifndef BUSQUEDA_TABU_H
+#define BUSQUEDA_TABU_H
+
+#include "Optimizador.h"
+
+// Búsqueda tabú sobre conjuntos de tamaño fijo. En cada iteración se evalúa
+// una muestra del vecindario (cambiar un problema elegido por uno libre) y
+// se aplica el mejor movimiento permitido aunque empeore. Un problema que
+// sale no puede volver a entrar durante `tenencia` iteraciones, salvo que
+// mejore la mejor solución conocida (criterio de aspiración). Se detiene al
+// agotar las iteraciones o tras `maxSinMejora` iteraciones sin progreso.
+class BusquedaTabu : public Optimizador {
+public:
+    struct Config {
+        int iteraciones = 500;
+        int vecindario = 48;   // movimientos evaluados por iteración
+        int tenencia = 0;      // 0 = automática según el tamaño de la maratón
+        int maxSinMejora = 100;
+    };
+
+    BusquedaTabu() = default;
+    explicit BusquedaTabu(Config config) : config(config) {}
+
+    std::string nombre() const override { return "tabu"; }
+
+    ResultadoOptimizacion optimizar(std::shared_ptr<const std::vector<Problema>> banco,
+                                    const Objetivo& objetivo,
+                                    unsigned int semilla) const override;
+
+private:
+    Config config;
+};
+
+#endif // BUSQUEDA_TABU_H
@@ -0,0 +1,128 @@
+#include "Optimizador.h"
+#include "AlgoritmoGeneticoConjunto.h"
+#include "AlgoritmoGeneticoFijo.h"
+#include "BusquedaTabu.h"
+#include "RecocidoSimulado.h"
+#include "metrics.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+// Adaptador del algoritmo genético (las tres variantes) a la interfaz común
+class OptimizadorGenetico : public Optimizador {
+public:
+    explicit OptimizadorGenetico(OpcionesGeneticas opciones) : opciones(std::move(opciones)) {}
+
+    std::string nombre() const override { return "ga"; }
+
+    ResultadoOptimizacion optimizar(std::shared_ptr<const std::vector<Problema>> banco,
+                                    const Objetivo& objetivo,
+                                    unsigned int semilla) const override {
+        auto inicio = std::chrono::steady_clock::now();
+        std::vector<Problema> problemas;
+        int64_t evaluaciones = 0;
+        if (opciones.codificacion == "set") {
+            AlgoritmoGeneticoConjunto ag(std::move(banco), objetivo.totalProblemas,
+                                         opciones.tamPoblacion, opciones.maxGeneraciones, semilla);
+            ag.setRefinamiento(opciones.refinamiento);
+            ag.setTelemetria(opciones.telemetria);
+            problemas = ag.ejecutar();
+            evaluaciones = ag.evaluacionesRealizadas();
+        } else {
+            // Versión especializada para 5..16 problemas; genérica en otro caso
+            problemas = ejecutarPermutacion(std::move(banco), objetivo.totalProblemas,
+                                            opciones.tamPoblacion, opciones.maxGeneraciones,
+                                            semilla, opciones.deduplicar, opciones.refinamiento,
+                                            opciones.telemetria, &evaluaciones);
+        }
+
+        ResultadoOptimizacion r;
+        r.problemas = std::move(problemas);
+        for (const auto& p : r.problemas) r.estadisticas.costo += p.tiempoPromedio;
+        // Medidas como en recocido y tabú: sin aciertos de la memo y
+        // cortando en la generación cancelada
+        r.estadisticas.evaluaciones = evaluaciones;
+        r.estadisticas.milisegundos = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - inicio).count();
+        return r;
+    }
+
+private:
+    OpcionesGeneticas opciones;
+};
+
+// Mide cada optimización en la fase "optimize_<motor>" de metrics
+class OptimizadorMedido : public Optimizador {
+public:
+    explicit OptimizadorMedido(std::unique_ptr<Optimizador> motor)
+        : motor(std::move(motor)), fase(metrics::phase("optimize_" + this->motor->nombre())) {}
+
+    std::string nombre() const override { return motor->nombre(); }
+
+    ResultadoOptimizacion optimizar(std::shared_ptr<const std::vector<Problema>> banco,
+                                    const Objetivo& objetivo,
+                                    unsigned int semilla) const override {
+        metrics::ScopedTimer timer(fase);
+        return motor->optimizar(std::move(banco), objetivo, semilla);
+    }
+
+private:
+    std::unique_ptr<Optimizador> motor;
+    metrics::SeriesId fase;
+};
+
+std::unique_ptr<Optimizador> crearMotor(const std::string& motor, const OpcionesGeneticas& opciones) {
+    if (motor == "ga") return std::make_unique<OptimizadorGenetico>(opciones);
+    if (motor == "sa") return std::make_unique<RecocidoSimulado>();
+    if (motor == "tabu") return std::make_unique<BusquedaTabu>();
+    return nullptr;
+}
+}
+
+std::unique_ptr<Optimizador> crearOptimizador(const std::string& motor,
+                                              const OpcionesGeneticas& opciones) {
+    auto optimizador = crearMotor(motor, opciones);
+    if (!optimizador) return nullptr;
+    return std::make_unique<OptimizadorMedido>(std::move(optimizador));
+}
+
+const std::vector<std::string>& motoresDisponibles() {
+    static const std::vector<std::string> motores = {"ga", "sa", "tabu"};
+    return motores;
+}
+
+namespace optimizacion {
+std::vector<uint32_t> seleccionAleatoria(uint32_t n, int k, std::mt19937& gen) {
+    std::vector<uint32_t> seleccion;
+    if (k <= 0 || n < static_cast<uint32_t>(k)) return seleccion;
+    if (static_cast<uint64_t>(k) * 4 > n) {
+        // Muchos elegidos: barajar es más barato que las búsquedas de Floyd
+        std::vector<uint32_t> todos(n);
+        for (uint32_t i = 0; i < n; ++i) todos[i] = i;
+        std::shuffle(todos.begin(), todos.end(), gen);
+        todos.resize(k);
+        return todos;
+    }
+    seleccion.reserve(k);
+    for (uint32_t j = n - k; j < n; ++j) {
+        uint32_t t = std::uniform_int_distribution<uint32_t>(0, j)(gen);
+        bool repetido = std::find(seleccion.begin(), seleccion.end(), t) != seleccion.end();
+        seleccion.push_back(repetido ? j : t);
+    }
+    return seleccion;
+}
+
+ResultadoOptimizacion resultado(const std::vector<Problema>& banco,
+                                const std::vector<uint32_t>& seleccion,
+                                int64_t evaluaciones, double milisegundos) {
+    ResultadoOptimizacion r;
+    r.problemas.reserve(seleccion.size());
+    for (uint32_t idx : seleccion) {
+        r.problemas.push_back(banco[idx]);
+        r.estadisticas.costo += banco[idx].tiempoPromedio;
+    }
+    r.estadisticas.evaluaciones = evaluaciones;
+    r.estadisticas.milisegundos = milisegundos;
+    return r;
+}
+}
@@ -0,0 +1,74 @@
+#ifndef OPTIMIZADOR_H
+#define OPTIMIZADOR_H
+
+#include "AlgoritmoGenetico.h"
+#include "BusquedaLocal.h"
+#include "Telemetria.h"
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// Qué se optimiza: elegir totalProblemas problemas distintos del banco
+// minimizando la suma de tiempoPromedio (el mismo criterio que el fitness
+// del algoritmo genético).
+struct Objetivo {
+    int totalProblemas = 0;
+};
+
+struct EstadisticasOptimizacion {
+    int64_t costo = 0;          // suma de tiempoPromedio de la selección
+    int64_t evaluaciones = 0;   // soluciones (o movimientos) evaluados
+    double milisegundos = 0.0;
+};
+
+struct ResultadoOptimizacion {
+    std::vector<Problema> problemas;
+    EstadisticasOptimizacion estadisticas;
+};
+
+// Motor de optimización intercambiable por petición ("ga", "sa", "tabu").
+// Las implementaciones no guardan estado entre llamadas y el banco es de
+// solo lectura, así que una instancia puede usarse desde varios hilos.
+class Optimizador {
+public:
+    virtual ~Optimizador() = default;
+
+    virtual std::string nombre() const = 0;
+
+    // Misma semilla, mismo banco y mismo objetivo => misma selección.
+    virtual ResultadoOptimizacion optimizar(std::shared_ptr<const std::vector<Problema>> banco,
+                                            const Objetivo& objetivo,
+                                            unsigned int semilla) const = 0;
+};
+
+// Parámetros del algoritmo genético (los demás motores los ignoran).
+struct OpcionesGeneticas {
+    std::string codificacion = "permutation"; // "permutation" o "set"
+    bool deduplicar = false;
+    Refinamiento refinamiento;
+    int tamPoblacion = 50;
+    int maxGeneraciones = 100;
+    CanalTelemetria* telemetria = nullptr; // progreso por generación (opcional)
+};
+
+// nullptr si el motor no existe.
+std::unique_ptr<Optimizador> crearOptimizador(const std::string& motor,
+                                              const OpcionesGeneticas& opciones = {});
+
+// Nombres aceptados por crearOptimizador.
+const std::vector<std::string>& motoresDisponibles();
+
+// Utilidades comunes a los motores de trayectoria (recocido y tabú)
+namespace optimizacion {
+// k índices distintos en [0, n) por muestreo de Floyd.
+std::vector<uint32_t> seleccionAleatoria(uint32_t n, int k, std::mt19937& gen);
+
+// Arma el resultado a partir de los índices elegidos.
+ResultadoOptimizacion resultado(const std::vector<Problema>& banco,
+                                const std::vector<uint32_t>& seleccion,
+                                int64_t evaluaciones, double milisegundos);
+}
+
+#endif // OPTIMIZADOR_H
@@ -0,0 +1,68 @@
+#include "RecocidoSimulado.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+ResultadoOptimizacion RecocidoSimulado::optimizar(std::shared_ptr<const std::vector<Problema>> banco,
+                                                  const Objetivo& objetivo,
+                                                  unsigned int semilla) const {
+    auto inicio = std::chrono::steady_clock::now();
+    const auto& datos = *banco;
+    uint32_t n = static_cast<uint32_t>(datos.size());
+    int k = std::min(objetivo.totalProblemas, static_cast<int>(n));
+
+    std::mt19937 gen(semilla);
+    std::vector<uint32_t> actual = optimizacion::seleccionAleatoria(n, k, gen);
+    auto transcurrido = [&] {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - inicio).count();
+    };
+    if (actual.empty() || static_cast<uint32_t>(k) == n) {
+        return optimizacion::resultado(datos, actual, 0, transcurrido());
+    }
+
+    std::vector<char> elegido(n, 0);
+    int64_t costo = 0;
+    for (uint32_t idx : actual) {
+        elegido[idx] = 1;
+        costo += datos[idx].tiempoPromedio;
+    }
+    std::vector<uint32_t> mejor = actual;
+    int64_t mejorCosto = costo;
+
+    std::uniform_int_distribution<int> posicion(0, k - 1);
+    std::uniform_int_distribution<uint32_t> problema(0, n - 1);
+    std::uniform_real_distribution<double> uniforme(0.0, 1.0);
+
+    // Temperatura inicial: diferencia media de movimientos al azar
+    double suma = 0.0;
+    const int muestras = 64;
+    for (int i = 0; i < muestras; ++i) {
+        suma += std::abs(datos[problema(gen)].tiempoPromedio - datos[actual[posicion(gen)]].tiempoPromedio);
+    }
+    double temperatura = std::max(suma / muestras, 1.0);
+    const double enfriamiento = std::pow(config.temperaturaFinalRelativa,
+                                         1.0 / static_cast<double>(std::max<int64_t>(config.iteraciones, 1)));
+
+    int64_t evaluaciones = 0;
+    for (int64_t it = 0; it < config.iteraciones; ++it, temperatura *= enfriamiento) {
+        uint32_t nuevo = problema(gen);
+        if (elegido[nuevo]) continue;
+        int i = posicion(gen);
+        ++evaluaciones;
+
+        int delta = datos[nuevo].tiempoPromedio - datos[actual[i]].tiempoPromedio;
+        if (delta > 0 && uniforme(gen) >= std::exp(-delta / temperatura)) continue;
+
+        elegido[actual[i]] = 0;
+        elegido[nuevo] = 1;
+        actual[i] = nuevo;
+        costo += delta;
+        if (costo < mejorCosto) {
+            mejorCosto = costo;
+            mejor = actual;
+        }
+    }
+
+    return optimizacion::resultado(datos, mejor, evaluaciones, transcurrido());
+}
@@ -0,0 +1,32 @@
+#ifndef RECOCIDO_SIMULADO_H
+#define RECOCIDO_SIMULADO_H
+
+#include "Optimizador.h"
+
+// Recocido simulado sobre conjuntos de tamaño fijo. El movimiento cambia un
+// problema elegido por uno libre; el costo varía solo en la diferencia de
+// sus tiempos, así cada paso cuesta O(1). Los movimientos que empeoran se
+// aceptan con probabilidad exp(-delta / T) y T baja geométricamente desde
+// una temperatura estimada con movimientos al azar hasta una milésima de
+// ella.
+class RecocidoSimulado : public Optimizador {
+public:
+    struct Config {
+        int64_t iteraciones = 20000;
+        double temperaturaFinalRelativa = 1e-3;
+    };
+
+    RecocidoSimulado() = default;
+    explicit RecocidoSimulado(Config config) : config(config) {}
+
+    std::string nombre() const override { return "sa"; }
+
+    ResultadoOptimizacion optimizar(std::shared_ptr<const std::vector<Problema>> banco,
+                                    const Objetivo& objetivo,
+                                    unsigned int semilla) const override;
+
+private:
+    Config config;
+};
+
+#endif // RECOCIDO_SIMULADO_H
@@ -0,0 +1,79 @@
+#ifndef TABLA_FITNESS_H
+#define TABLA_FITNESS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Hash canónico de individuos y memo de fitness para una ejecución del
+// algoritmo genético.
+// El hash es de Zobrist: una clave aleatoria de 64 bits por problema del banco
+// y el XOR de las claves del individuo. No depende del orden de los genes,
+// igual que el fitness, así dos permutaciones del mismo conjunto comparten
+// entrada. La memo es una tabla de direccionamiento abierto (sondeo lineal)
+// de capacidad fija; cuando se llena deja de guardar y solo consulta.
+class TablaFitness {
+public:
+    TablaFitness(size_t tamBanco, size_t capacidad, uint64_t semilla) {
+        claves.resize(tamBanco);
+        uint64_t x = semilla;
+        for (auto& k : claves) k = splitmix64(x);
+
+        size_t cap = 16;
+        while (cap < capacidad * 2) cap <<= 1; // factor de carga <= 0.5
+        hashes.assign(cap, 0);
+        valores.assign(cap, 0.0);
+        mask = cap - 1;
+        limite = capacidad;
+    }
+
+    template<typename It>
+    uint64_t hash(It primero, It ultimo) const {
+        uint64_t h = 0;
+        for (; primero != ultimo; ++primero) h ^= claves[*primero];
+        return h ? h : 1; // 0 marca celda vacía
+    }
+
+    bool buscar(uint64_t h, double& fitness) {
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            if (hashes[i] == h) {
+                fitness = valores[i];
+                ++aciertos;
+                return true;
+            }
+            if (hashes[i] == 0) {
+                ++fallos;
+                return false;
+            }
+        }
+    }
+
+    void guardar(uint64_t h, double fitness) {
+        if (ocupadas >= limite) return;
+        size_t i = h & mask;
+        while (hashes[i] != 0 && hashes[i] != h) i = (i + 1) & mask;
+        if (hashes[i] == 0) ++ocupadas;
+        hashes[i] = h;
+        valores[i] = fitness;
+    }
+
+    size_t aciertos = 0;
+    size_t fallos = 0;
+
+private:
+    static uint64_t splitmix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    std::vector<uint64_t> claves;
+    std::vector<uint64_t> hashes;
+    std::vector<double> valores;
+    size_t mask = 0;
+    size_t limite = 0;
+    size_t ocupadas = 0;
+};
+
+#endif // TABLA_FITNESS_H
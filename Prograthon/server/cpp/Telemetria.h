@@ -0,0 +1,146 @@
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <numeric>
+#include <vector>
+
+// Resumen de una generación del algoritmo genético.
+struct MuestraGeneracion {
+    int generacion = 0;
+    double mejorFitness = 0.0;
+    double fitnessMedio = 0.0;
+    double diversidad = 0.0;   // fracción de individuos distintos (0..1]
+    int64_t microsegundos = 0; // desde el inicio de ejecutar()
+};
+
+// Canal sin bloqueos entre el hilo que ejecuta el algoritmo (productor) y el
+// que escribe la respuesta (consumidor): un anillo SPSC con dos índices
+// atómicos. Si el consumidor se atrasa y el anillo se llena, las muestras
+// nuevas se descartan en lugar de frenar al algoritmo. El consumidor puede
+// dormir en esperar(); el productor solo toma el mutex para despertarlo
+// cuando sabe que está dormido.
+class CanalTelemetria {
+public:
+    explicit CanalTelemetria(size_t capacidad = 1024) {
+        size_t cap = 2;
+        while (cap < capacidad) cap <<= 1;
+        buffer.resize(cap);
+        mask = cap - 1;
+    }
+
+    // Solo desde el hilo del algoritmo.
+    bool publicar(const MuestraGeneracion& m) noexcept {
+        size_t c = cola.load(std::memory_order_relaxed);
+        if (c - cabeza.load(std::memory_order_acquire) > mask) {
+            descartadas.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        buffer[c & mask] = m;
+        cola.store(c + 1, std::memory_order_release);
+        despertarConsumidor();
+        return true;
+    }
+
+    // Solo desde el hilo del algoritmo, al terminar: no habrá más muestras.
+    void cerrar() {
+        cerrado.store(true, std::memory_order_release);
+        despertarConsumidor();
+    }
+
+    // Solo desde el hilo consumidor: vuelve cuando hay muestras, el canal se
+    // cerró o pasó `espera`.
+    template<typename Rep, typename Period>
+    void esperar(std::chrono::duration<Rep, Period> espera) {
+        std::unique_lock<std::mutex> lock(mutex);
+        dormido.store(true, std::memory_order_relaxed);
+        // Pareja de la barrera de despertarConsumidor(): o el productor ve
+        // dormido=true, o aquí se ve su muestra
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        cv.wait_for(lock, espera, [&] {
+            return cola.load(std::memory_order_acquire) != cabeza.load(std::memory_order_relaxed) ||
+                   cerrado.load(std::memory_order_acquire);
+        });
+        dormido.store(false, std::memory_order_relaxed);
+    }
+
+    // Solo desde el hilo consumidor.
+    bool consumir(MuestraGeneracion& m) noexcept {
+        size_t h = cabeza.load(std::memory_order_relaxed);
+        if (h == cola.load(std::memory_order_acquire)) return false;
+        m = buffer[h & mask];
+        cabeza.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // El consumidor pide detener el algoritmo (p. ej. el cliente se desconectó).
+    void cancelar() noexcept { cancelada.store(true, std::memory_order_relaxed); }
+    bool cancelado() const noexcept { return cancelada.load(std::memory_order_relaxed); }
+
+    uint64_t perdidas() const noexcept { return descartadas.load(std::memory_order_relaxed); }
+
+private:
+    void despertarConsumidor() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (!dormido.load(std::memory_order_relaxed)) return;
+        // Tomar el mutex asegura que el consumidor ya está en wait_for
+        std::lock_guard<std::mutex> lock(mutex);
+        cv.notify_one();
+    }
+
+    std::vector<MuestraGeneracion> buffer;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> cabeza{0};
+    alignas(64) std::atomic<size_t> cola{0};
+    std::atomic<uint64_t> descartadas{0};
+    std::atomic<bool> cancelada{false};
+    std::atomic<bool> cerrado{false};
+    std::atomic<bool> dormido{false};
+    std::mutex mutex;
+    std::condition_variable cv;
+};
+
+namespace telemetria {
+inline uint64_t mezclar(uint64_t x) {
+    uint64_t z = x + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Huella de un conjunto de índices que no depende del orden de los genes.
+template<typename It>
+uint64_t huella(It primero, It ultimo) {
+    uint64_t h = 0;
+    for (; primero != ultimo; ++primero) h += mezclar(static_cast<uint64_t>(*primero));
+    return h;
+}
+
+// Arma la muestra de una generación; huellas se reordena.
+inline MuestraGeneracion resumir(int generacion, const std::vector<double>& fitnesses,
+                                 std::vector<uint64_t>& huellas,
+                                 std::chrono::steady_clock::time_point inicio) {
+    MuestraGeneracion m;
+    m.generacion = generacion;
+    if (!fitnesses.empty()) {
+        m.mejorFitness = *std::max_element(fitnesses.begin(), fitnesses.end());
+        m.fitnessMedio = std::accumulate(fitnesses.begin(), fitnesses.end(), 0.0) / fitnesses.size();
+    }
+    if (!huellas.empty()) {
+        std::sort(huellas.begin(), huellas.end());
+        size_t distintos = std::unique(huellas.begin(), huellas.end()) - huellas.begin();
+        m.diversidad = static_cast<double>(distintos) / static_cast<double>(huellas.size());
+    }
+    m.microsegundos = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - inicio).count();
+    return m;
+}
+}
+
+#endif // TELEMETRIA_H
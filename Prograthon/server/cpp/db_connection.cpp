@@ -1,10 +1,28 @@
 #include "db_connection.h"
 #include <iostream>
 #include <cstdlib> // Para std::getenv
+#include <thread>
+#include <algorithm>
 
 // Inicialización de los punteros estáticos a nullptr.
 std::unique_ptr<mongocxx::instance> DBConnection::instance = nullptr;
-std::unique_ptr<mongocxx::client> DBConnection::client = nullptr;
+std::unique_ptr<mongocxx::pool> DBConnection::pool = nullptr;
+std::chrono::milliseconds DBConnection::waitQueueTimeout{0};
+
+namespace {
+// Lee una variable de entorno; devuelve "" si no está definida.
+std::string env_or_empty(const char* name) {
+    const char* v = std::getenv(name);
+    return v ? std::string(v) : std::string();
+}
+
+// Añade una opción a la query string de la URI sin pisar las que ya tenga.
+void append_uri_option(std::string& uri, const std::string& key, const std::string& value) {
+    if (value.empty() || uri.find(key + "=") != std::string::npos) return;
+    uri += (uri.find('?') == std::string::npos) ? '?' : '&';
+    uri += key + "=" + value;
+}
+}
 
 // El constructor privado se llama solo una vez, la primera vez que se accede a la BD.
 DBConnection::DBConnection() {
@@ -15,12 +33,21 @@ DBConnection::DBConnection() {
             std::cerr << "ERROR FATAL: La variable de entorno ATLAS_URI no está configurada." << std::endl;
             exit(EXIT_FAILURE);
         }
+
+        // Tamaño del pool configurable (MONGO_MAX_POOL_SIZE, MONGO_MIN_POOL_SIZE).
+        std::string uri_str(uri_env);
+        append_uri_option(uri_str, "maxPoolSize", env_or_empty("MONGO_MAX_POOL_SIZE"));
+        append_uri_option(uri_str, "minPoolSize", env_or_empty("MONGO_MIN_POOL_SIZE"));
+
+        // Espera máxima por un cliente libre (MONGO_WAIT_QUEUE_TIMEOUT_MS, 0 = sin límite).
+        std::string wait_ms = env_or_empty("MONGO_WAIT_QUEUE_TIMEOUT_MS");
+        if (!wait_ms.empty()) waitQueueTimeout = std::chrono::milliseconds(std::stoll(wait_ms));
+
+        mongocxx::uri uri = mongocxx::uri{uri_str};
         
-        mongocxx::uri uri = mongocxx::uri{std::string(uri_env)};
-        
-        // Crea la instancia del driver y el cliente que se conecta al clúster.
+        // Crea la instancia del driver y el pool de clientes del clúster.
         instance = std::make_unique<mongocxx::instance>();
-        client = std::make_unique<mongocxx::client>(uri);
+        pool = std::make_unique<mongocxx::pool>(uri);
 
     } catch (const std::exception& e) {
         std::cerr << "Error de conexión con MongoDB: " << e.what() << std::endl;
@@ -28,12 +55,31 @@ DBConnection::DBConnection() {
     }
 }
 
-// Este es el método público que usarás en tu API para obtener la base de datos.
-mongocxx::database DBConnection::get_db() {
-    // Patrón Singleton: si el cliente no existe, crea una instancia de DBConnection.
-    if (!client) {
-        static DBConnection db_singleton;
+DBConnection::Client DBConnection::acquire() {
+    // Patrón Singleton: si el pool no existe, crea una instancia de DBConnection.
+    static DBConnection db_singleton;
+
+    if (waitQueueTimeout.count() <= 0) {
+        return pool->acquire();
+    }
+
+    // mongoc bloquea indefinidamente en acquire(); con límite se reintenta
+    // try_acquire() con esperas crecientes hasta agotar el plazo.
+    auto deadline = std::chrono::steady_clock::now() + waitQueueTimeout;
+    auto backoff = std::chrono::microseconds(100);
+    for (;;) {
+        if (auto entry = pool->try_acquire()) {
+            return std::move(*entry);
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            throw PoolTimeout("No hay conexiones libres con MongoDB");
+        }
+        std::this_thread::sleep_for(backoff);
+        backoff = std::min(backoff * 2, std::chrono::microseconds(10000));
     }
-    // Devuelve un manejador para la base de datos "Prograthon".
-    return (*client)["Prograthon"]; 
-}
\ No newline at end of file
+}
+
+// Devuelve un manejador para la base de datos "Prograthon".
+mongocxx::database DBConnection::get_db(mongocxx::client& client) {
+    return client["Prograthon"];
+}
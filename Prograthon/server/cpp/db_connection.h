@@ -4,21 +4,37 @@
 #include <mongocxx/client.hpp>
 #include <mongocxx/instance.hpp>
 #include <mongocxx/database.hpp>
+#include <mongocxx/pool.hpp>
+#include <chrono>
+#include <stdexcept>
 #include <string>
 #include <memory>
 
 class DBConnection {
 public:
-    // Método estático para obtener la instancia de la base de datos "Prograthon"
-    static mongocxx::database get_db();
+    // Cliente prestado del pool; vuelve al pool al destruirse (RAII).
+    using Client = mongocxx::pool::entry;
+
+    // Se lanza cuando no hay clientes libres dentro del tiempo de espera.
+    struct PoolTimeout : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    // Saca un cliente del pool. mongocxx::client no es thread-safe, así que
+    // cada petición debe usar el suyo y no compartirlo con otros hilos.
+    static Client acquire();
+
+    // Manejador de la base de datos "Prograthon" para un cliente prestado.
+    static mongocxx::database get_db(mongocxx::client& client);
 
 private:
     // El constructor es privado para implementar el patrón Singleton
     DBConnection(); 
 
-    // Punteros únicos para gestionar la instancia y el cliente de MongoDB
+    // Punteros únicos para gestionar la instancia y el pool de MongoDB
     static std::unique_ptr<mongocxx::instance> instance;
-    static std::unique_ptr<mongocxx::client> client;
+    static std::unique_ptr<mongocxx::pool> pool;
+    static std::chrono::milliseconds waitQueueTimeout;
 };
 
-#endif // DB_CONNECTION_H
\ No newline at end of file
+#endif // DB_CONNECTION_H
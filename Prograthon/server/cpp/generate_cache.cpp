@@ -0,0 +1,75 @@
+#include "generate_cache.h"
+#include <algorithm>
+#include <cstdlib>
+
+GenerateCache::GenerateCache(size_t capacidad) : capacidad(capacidad) {}
+
+size_t GenerateCache::capacityFromEnv() {
+    const char* v = std::getenv("GENERATE_CACHE_MAX");
+    if (!v || !*v) return 256;
+    try {
+        return static_cast<size_t>(std::stoull(v));
+    } catch (...) {
+        return 256;
+    }
+}
+
+std::string GenerateCache::clave(const std::string& algoritmo,
+                                 const std::string& dificultad,
+                                 std::vector<std::string> temas,
+                                 int cantidad,
+                                 std::optional<unsigned int> semilla,
+                                 uint64_t versionBanco) {
+    std::sort(temas.begin(), temas.end());
+    temas.erase(std::unique(temas.begin(), temas.end()), temas.end());
+
+    // Longitud delante de cada texto para que ningún separador sea ambiguo
+    std::string k;
+    k += std::to_string(algoritmo.size()) + ":" + algoritmo + "|";
+    k += std::to_string(dificultad.size()) + ":" + dificultad + "|";
+    for (const auto& t : temas) k += std::to_string(t.size()) + ":" + t + ",";
+    k += "|" + std::to_string(cantidad);
+    k += "|" + (semilla ? std::to_string(*semilla) : std::string("-"));
+    k += "|" + std::to_string(versionBanco);
+    return k;
+}
+
+std::optional<std::vector<Problema>> GenerateCache::buscar(const std::string& clave) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = indice.find(clave);
+    if (it == indice.end()) {
+        misses.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    hits.fetch_add(1, std::memory_order_relaxed);
+    lru.splice(lru.begin(), lru, it->second);
+    return it->second->second;
+}
+
+void GenerateCache::guardar(const std::string& clave, std::vector<Problema> resultado) {
+    if (capacidad == 0) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = indice.find(clave);
+    if (it != indice.end()) {
+        it->second->second = std::move(resultado);
+        lru.splice(lru.begin(), lru, it->second);
+        return;
+    }
+    lru.emplace_front(clave, std::move(resultado));
+    indice[clave] = lru.begin();
+    if (lru.size() > capacidad) {
+        indice.erase(lru.back().first);
+        lru.pop_back();
+    }
+}
+
+void GenerateCache::limpiar() {
+    std::lock_guard<std::mutex> lock(mutex);
+    lru.clear();
+    indice.clear();
+}
+
+size_t GenerateCache::tamano() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lru.size();
+}
@@ -0,0 +1,51 @@
+#ifndef GENERATE_CACHE_H
+#define GENERATE_CACHE_H
+
+#include "AlgoritmoGenetico.h"
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Memoización de /generate: peticiones idénticas sobre la misma versión del
+// banco devuelven la misma selección sin volver a ejecutar el algoritmo.
+// Capacidad acotada con expulsión LRU (GENERATE_CACHE_MAX, 0 = desactivada).
+class GenerateCache {
+public:
+    explicit GenerateCache(size_t capacidad);
+
+    static size_t capacityFromEnv();
+
+    // Clave canónica: temas ordenados y sin repetir, semilla opcional y
+    // variante del algoritmo (codificación, parámetros...).
+    static std::string clave(const std::string& algoritmo,
+                             const std::string& dificultad,
+                             std::vector<std::string> temas,
+                             int cantidad,
+                             std::optional<unsigned int> semilla,
+                             uint64_t versionBanco);
+
+    std::optional<std::vector<Problema>> buscar(const std::string& clave);
+    void guardar(const std::string& clave, std::vector<Problema> resultado);
+    void limpiar();
+
+    uint64_t aciertos() const { return hits.load(std::memory_order_relaxed); }
+    uint64_t fallos() const { return misses.load(std::memory_order_relaxed); }
+    size_t tamano();
+
+private:
+    using Lista = std::list<std::pair<std::string, std::vector<Problema>>>;
+
+    size_t capacidad;
+    std::mutex mutex;
+    Lista lru; // más reciente al frente
+    std::unordered_map<std::string, Lista::iterator> indice;
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+};
+
+#endif // GENERATE_CACHE_H
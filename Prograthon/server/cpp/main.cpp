@@ -1,7 +1,16 @@
 #include "httplib.h"
 #include "json.hpp"
 #include "db_connection.h"
-#include "AlgoritmoGenetico.h"
+#include "Optimizador.h"
+#include "AlgoritmoNSGA2.h"
+#include "server_bootstrap.h"
+#include "marathon_writer.h"
+#include "problem_bank.h"
+#include "generate_cache.h"
+#include "reservation_index.h"
+#include "trie_router.h"
+#include "response_compression.h"
+#include "metrics.h"
 
 #include <bsoncxx/json.hpp>
 #include <bsoncxx/builder/stream/document.hpp>
@@ -10,6 +19,18 @@
 #include <iostream>
 #include <vector>
 #include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <map>
+#include <memory>
+#include <optional>
+#include <mutex>
+#include <thread>
 
 // Alias para simplificar el código
 using json = nlohmann::json;
@@ -20,106 +41,932 @@ using bsoncxx::builder::stream::open_array;
 using bsoncxx::builder::stream::close_array;
 using bsoncxx::builder::stream::finalize;
 
+// Servidores activos, para detenerlos desde el manejador de señales
+static ListenerGroup* running_servers = nullptr;
+
+// Máximo de maratones por petición a /generate/batch
+static const size_t MAX_BATCH_SPECS = 100;
+
+// Máximo de alternativas que devuelve /generate en modo "pareto"
+static const int MAX_ALTERNATIVAS = 20;
+
+// Búsqueda local tras el algoritmo genético; se cambia con PUT /config
+static std::mutex refinamiento_mutex;
+static Refinamiento refinamiento_actual = Refinamiento::fromEnv();
+
+static Refinamiento refinamiento_vigente() {
+    std::lock_guard<std::mutex> lock(refinamiento_mutex);
+    return refinamiento_actual;
+}
+
+// Respuestas de /generate y /optimizers: la serialización se mide aparte
+static const metrics::SeriesId FASE_SERIALIZE = metrics::phase("serialize");
+
+static std::string volcar_medido(const json& j) {
+    metrics::ScopedTimer timer(FASE_SERIALIZE);
+    return j.dump();
+}
+
+// Endpoints de administración (PUT /config, /cache/invalidate,
+// /reservations/rebuild). Con ADMIN_TOKEN se exige
+// "Authorization: Bearer <token>"; sin él solo se aceptan desde la propia
+// máquina.
+static const std::string admin_token = [] {
+    const char* v = std::getenv("ADMIN_TOKEN");
+    return std::string(v ? v : "");
+}();
+
+static bool autorizar_admin(const httplib::Request& req, httplib::Response& res) {
+    bool ok;
+    if (!admin_token.empty()) {
+        std::string h = req.get_header_value("Authorization");
+        // Comparación en tiempo constante sobre el largo esperado
+        ok = h.size() == 7 + admin_token.size() && h.compare(0, 7, "Bearer ") == 0;
+        unsigned char diff = 0;
+        for (size_t i = 0; ok && i < admin_token.size(); ++i) diff |= h[7 + i] ^ admin_token[i];
+        ok = ok && diff == 0;
+    } else {
+        ok = req.remote_addr == "127.0.0.1" || req.remote_addr == "::1" ||
+             req.remote_addr == "::ffff:127.0.0.1";
+    }
+    if (!ok) {
+        res.status = 403;
+        res.set_content(json{{"error", "Operación reservada a administración."}}.dump(), "application/json");
+    }
+    return ok;
+}
+
+// Parte de la clave de caché que depende del motor y sus opciones
+static std::string variante_motor(const std::string& motor, const OpcionesGeneticas& opciones) {
+    if (motor != "ga") return motor;
+    std::string variante = opciones.codificacion;
+    if (opciones.deduplicar) variante += "+dedup";
+    if (opciones.refinamiento.activo()) {
+        variante += "+ls" + std::to_string(opciones.refinamiento.topK) + "x" +
+                    std::to_string(opciones.refinamiento.maxPasos);
+    }
+    return variante;
+}
+
+static bool codificacion_valida(const std::string& codificacion) {
+    return codificacion == "permutation" || codificacion == "set";
+}
+
+// Lee "engine", "encoding" y "dedup" de una petición (o de un spec del lote).
+// Devuelve el mensaje de error si algún valor no es válido.
+// encoding: "permutation" (vector ordenado de índices) o "set" (bitset).
+// dedup: los clones que deja la selección se sustituyen por variantes a un
+// gen de distancia (solo codificación por permutación).
+static std::optional<std::string> leer_motor(const json& entrada, const Refinamiento& refinamiento,
+                                             std::string& motor, OpcionesGeneticas& opciones) {
+    motor = entrada.value("engine", "ga");
+    opciones.codificacion = entrada.value("encoding", "permutation");
+    opciones.deduplicar = entrada.value("dedup", false);
+    opciones.refinamiento = refinamiento;
+    const auto& motores = motoresDisponibles();
+    if (std::find(motores.begin(), motores.end(), motor) == motores.end()) {
+        return std::string("engine debe ser 'ga', 'sa' o 'tabu'.");
+    }
+    if (!codificacion_valida(opciones.codificacion)) {
+        return std::string("encoding debe ser 'permutation' o 'set'.");
+    }
+    // La variante por conjuntos no deduplica; aceptarlo daría otra clave de
+    // caché para el mismo resultado
+    if (motor == "ga" && opciones.deduplicar && opciones.codificacion == "set") {
+        return std::string("dedup solo está disponible con encoding 'permutation'.");
+    }
+    return std::nullopt;
+}
+
+// Ejecución de /generate/stream: el algoritmo corre en su propio hilo y
+// publica en el canal; la respuesta lo consume. El hilo solo toca esta
+// estructura (la escritura en MongoDB la hace el proveedor de contenido).
+// Sesiones de /generate/stream simultáneas. Cada una ocupa un hilo del pool
+// HTTP y otro de cálculo (STREAM_MAX_SESSIONS, 0 = mitad de los núcleos).
+static const size_t max_sesiones_stream = [] {
+    size_t maximo = 0;
+    if (const char* v = std::getenv("STREAM_MAX_SESSIONS"); v && *v) {
+        try {
+            maximo = static_cast<size_t>(std::stoull(v));
+        } catch (...) {
+            std::cerr << "Valor inválido para STREAM_MAX_SESSIONS: " << v << std::endl;
+        }
+    }
+    return maximo ? maximo : std::max<size_t>(1, std::thread::hardware_concurrency() / 2);
+}();
+static std::atomic<size_t> sesiones_stream{0};
+
+// Se toma antes de crear la sesión; la sesión lo devuelve al destruirse,
+// cuando ya terminaron tanto el cálculo como el flujo.
+static bool tomar_sesion_stream() {
+    if (sesiones_stream.fetch_add(1, std::memory_order_acq_rel) < max_sesiones_stream) return true;
+    sesiones_stream.fetch_sub(1, std::memory_order_acq_rel);
+    return false;
+}
+
+struct SesionProgreso {
+    CanalTelemetria canal;
+    std::atomic<bool> terminado{false};
+    ResultadoOptimizacion resultado;
+    std::string error;
+
+    ~SesionProgreso() { sesiones_stream.fetch_sub(1, std::memory_order_acq_rel); }
+};
+
+// Hilos de cálculo de /generate/stream. Se guardan para cancelarlos y
+// esperarlos al apagar, antes de vaciar la cola de escritura; los que ya
+// terminaron se recogen al lanzar el siguiente.
+class CalculosStream {
+public:
+    ~CalculosStream() { cancelarYEsperar(); }
+
+    void lanzar(const std::shared_ptr<SesionProgreso>& sesion, std::function<void()> calculo) {
+        std::lock_guard<std::mutex> lock(mutex);
+        recoger();
+        if (apagando) throw std::runtime_error("El servidor se está apagando.");
+        auto hecho = std::make_shared<std::atomic<bool>>(false);
+        std::thread hilo([calculo = std::move(calculo), hecho] {
+            calculo();
+            hecho->store(true, std::memory_order_release);
+        });
+        hilos.push_back({sesion, std::move(hecho), std::move(hilo)});
+    }
+
+    void cancelarYEsperar() {
+        std::vector<Calculo> pendientes;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            apagando = true;
+            pendientes.swap(hilos);
+        }
+        for (auto& c : pendientes) {
+            if (auto sesion = c.sesion.lock()) sesion->canal.cancelar();
+        }
+        for (auto& c : pendientes) c.hilo.join();
+    }
+
+private:
+    struct Calculo {
+        // weak_ptr: la sesión (y su plaza en STREAM_MAX_SESSIONS) se libera
+        // en cuanto terminan el cálculo y el flujo, sin esperar a recoger()
+        std::weak_ptr<SesionProgreso> sesion;
+        std::shared_ptr<std::atomic<bool>> hecho;
+        std::thread hilo;
+    };
+
+    void recoger() {
+        auto fin = std::remove_if(hilos.begin(), hilos.end(), [](Calculo& c) {
+            if (!c.hecho->load(std::memory_order_acquire)) return false;
+            c.hilo.join();
+            return true;
+        });
+        hilos.erase(fin, hilos.end());
+    }
+
+    std::mutex mutex;
+    std::vector<Calculo> hilos;
+    bool apagando = false;
+};
+
+static std::string evento_sse(const char* evento, const json& datos) {
+    return std::string("event: ") + evento + "\ndata: " + datos.dump() + "\n\n";
+}
+
+// Qué hacer con los problemas que ya están en maratones activas:
+// "allow" (ignorarlo, por defecto), "avoid" (penalizarlos) o "forbid" (excluirlos).
+static bool reuso_valido(const std::string& reuso) {
+    return reuso == "allow" || reuso == "avoid" || reuso == "forbid";
+}
+
+// Banco que ve el algoritmo después de aplicar las reservas.
+struct BancoAjustado {
+    std::shared_ptr<const std::vector<Problema>> problemas;
+    std::map<bsoncxx::oid, int> tiemposOriginales; // solo los penalizados
+    uint64_t huella = 0; // hash de los conteos de reservas del banco (0 = ninguna)
+};
+
+// "avoid" suma a cada problema reservado el mayor tiempo del banco por cada
+// maratón que lo usa: cualquier problema libre le gana a uno reservado, pero
+// si no alcanzan los libres se reutilizan los menos usados (el tiempo
+// penalizado se satura en INT_MAX). Todos los motores lo respetan porque solo
+// ven el banco ajustado.
+static BancoAjustado aplicar_reservas(std::shared_ptr<const std::vector<Problema>> banco,
+                                      const ReservationIndex& reservas,
+                                      const std::string& reuso) {
+    BancoAjustado ajustado{banco, {}, 0};
+    if (reuso == "allow") return ajustado;
+
+    auto conteos = reservas.conteos(*banco);
+    if (std::all_of(conteos.begin(), conteos.end(), [](uint16_t c) { return c == 0; })) {
+        return ajustado;
+    }
+    // FNV-1a sobre los conteos: reservas de problemas fuera del banco no la cambian
+    ajustado.huella = 14695981039346656037ULL;
+    for (uint16_t c : conteos) {
+        ajustado.huella ^= c;
+        ajustado.huella *= 1099511628211ULL;
+    }
+
+    auto copia = std::make_shared<std::vector<Problema>>();
+    copia->reserve(banco->size());
+    int64_t penalizacion = 1;
+    for (const auto& p : *banco) penalizacion = std::max<int64_t>(penalizacion, int64_t{p.tiempoPromedio} + 1);
+    for (size_t i = 0; i < banco->size(); ++i) {
+        const Problema& p = (*banco)[i];
+        if (conteos[i] == 0) {
+            copia->push_back(p);
+        } else if (reuso == "avoid") {
+            ajustado.tiemposOriginales[p.id] = p.tiempoPromedio;
+            int64_t penalizado = p.tiempoPromedio + penalizacion * conteos[i];
+            copia->push_back({p.id,
+                              static_cast<int>(std::min<int64_t>(penalizado, std::numeric_limits<int>::max())),
+                              p.dificultad});
+        }
+    }
+    ajustado.problemas = std::move(copia);
+    return ajustado;
+}
+
+// Devuelve a los problemas elegidos su tiempo real.
+static void restaurar_tiempos(const BancoAjustado& ajustado, std::vector<Problema>& problemas) {
+    if (ajustado.tiemposOriginales.empty()) return;
+    for (auto& p : problemas) {
+        auto it = ajustado.tiemposOriginales.find(p.id);
+        if (it != ajustado.tiemposOriginales.end()) p.tiempoPromedio = it->second;
+    }
+}
+
+static json estadisticas_json(const std::string& motor, const EstadisticasOptimizacion& e) {
+    return json{{"engine", motor}, {"cost", e.costo}, {"evaluations", e.evaluaciones}, {"ms", e.milisegundos}};
+}
+
+// Documento de una maratón generada. El _id se genera en el servidor para
+// poder responder sin esperar la escritura (ver MarathonWriter).
+static bsoncxx::document::value construir_maraton(const bsoncxx::oid& marathon_id,
+                                                  const std::vector<Problema>& problemas) {
+    auto builder = document{};
+    auto array_builder = builder
+        << "_id" << marathon_id
+        << "nombre" << "Maraton Generada IA - " + std::to_string(time(0))
+        << "cantidadProblemas" << static_cast<int32_t>(problemas.size())
+        << "createdAt" << bsoncxx::types::b_date{std::chrono::system_clock::now()}
+        << "participantes" << open_array << close_array // Array de participantes vacío
+        << "problemas" << open_array;
+
+    for (const auto& p : problemas) {
+        array_builder << p.id;
+    }
+
+    return array_builder << close_array << finalize;
+}
+
 int main() {
-    httplib::Server svr;
+    // Hilos, cola, keep-alive, backlog y listeners (variables de entorno HTTP_*)
+    ListenerGroup servers(ServerConfig::fromEnv());
+    // gzip negociado para respuestas grandes (variables HTTP_COMPRESSION_*)
+    ResponseCompressor compressor(CompressionConfig::fromEnv());
+    // Rutas en un trie radix; se conectan al servidor antes de escuchar
+    TrieRouter router;
     
-    // Obtiene el manejador de la base de datos al iniciar.
-    auto db = DBConnection::get_db();
+    // Abre el pool al iniciar; cada petición toma su propio cliente.
+    DBConnection::acquire();
     std::cout << "Conectado a MongoDB. API lista." << std::endl;
 
+    // Escritura de maratones generadas (MARATHON_DURABILITY, MARATHON_BATCH_SIZE...)
+    MarathonWriter marathon_writer(MarathonWriter::Config::fromEnv());
+
+    // Banco de problemas en memoria y memoización de resultados de /generate
+    ProblemBank problem_bank(ProblemBank::ttlFromEnv());
+    GenerateCache generate_cache(GenerateCache::capacityFromEnv());
+
+    // Problemas en maratones activas; se actualiza con cada maratón generada
+    ReservationIndex reservation_index(ReservationIndex::windowFromEnv());
+    reservation_index.reconstruir();
+
+    // Hilos de /generate/stream en curso
+    CalculosStream calculos_stream;
+
     // ENDPOINT: POST /generate
-    svr.Post("/generate", [&](const httplib::Request& req, httplib::Response& res) {
-        res.set_content_type("application/json");
+    router.Post("/generate", [&](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Content-Type", "application/json");
 
         try {
             auto input = json::parse(req.body);
             std::string difficulty = input.value("dificulty", ""); // Nota: frontend envía "dificulty"
             std::vector<std::string> topics = input.value("topics", std::vector<std::string>{});
             int problem_count = input.value("problem_count", 0);
+            std::optional<unsigned int> seed;
+            if (input.contains("seed")) seed = input.at("seed").get<unsigned int>();
+            std::string motor;
+            OpcionesGeneticas opciones;
+            auto error_motor = leer_motor(input, refinamiento_vigente(), motor, opciones);
+            std::string reuso = input.value("reuse", "allow");
 
             if (problem_count <= 0) {
                 res.status = 400;
                 res.set_content(json{{"error", "problem_count debe ser mayor a 0."}}.dump(), "application/json");
                 return;
             }
-
-            // Consultar problemas en MongoDB
-            auto problemas_coll = db["Problemas"];
-            // TODO: Se puede expandir el filtro para usar difficulty y topics
-            document filter_builder{};
-            
-            std::vector<Problema> problemas_disponibles;
-            for (const auto& doc : problemas_coll.find(filter_builder.view())) {
-                problemas_disponibles.push_back({
-                    doc["_id"].get_oid().value.to_string(),
-                    doc["nombre"].get_string().value.to_string(),
-                    doc["tiempoPromedio"].get_int32().value,
-                    doc["dificultad"].get_int32().value
-                });
+            if (error_motor) {
+                res.status = 400;
+                res.set_content(json{{"error", *error_motor}}.dump(), "application/json");
+                return;
+            }
+            if (!reuso_valido(reuso)) {
+                res.status = 400;
+                res.set_content(json{{"error", "reuse debe ser 'allow', 'avoid' o 'forbid'."}}.dump(), "application/json");
+                return;
             }
+
+            // Banco de problemas (se relee de MongoDB solo si caducó)
+            auto banco = problem_bank.snapshot();
             
-            if (problemas_disponibles.size() < problem_count) {
+            if (banco.problemas->size() < static_cast<size_t>(problem_count)) {
                  res.status = 400;
                  res.set_content(json{{"error", "No hay suficientes problemas en la base de datos."}}.dump(), "application/json");
                  return;
             }
 
-            // Ejecutar algoritmo genético
-            AlgoritmoGenetico ag(problemas_disponibles, problem_count, 50, 100);
-            std::vector<Problema> problemas_optimizados = ag.ejecutar();
+            // Problemas ya usados en maratones activas
+            auto ajustado = aplicar_reservas(banco.problemas, reservation_index, reuso);
+            if (ajustado.problemas->size() < static_cast<size_t>(problem_count)) {
+                res.status = 409; // Conflict
+                res.set_content(json{{"error", "No hay suficientes problemas libres de maratones activas."}}.dump(), "application/json");
+                return;
+            }
+
+            // Modo "pareto": una ejecución de NSGA-II que devuelve el frente
+            // de alternativas no dominadas sin guardarlas. Con "pick" se
+            // guarda (y reserva) solo la alternativa elegida. No pasa por la caché.
+            if (input.value("mode", "single") == "pareto") {
+                int alternativas = input.value("max_alternatives", 5);
+                if (alternativas <= 0 || alternativas > MAX_ALTERNATIVAS) {
+                    res.status = 400;
+                    res.set_content(json{{"error", "max_alternatives debe estar entre 1 y " + std::to_string(MAX_ALTERNATIVAS) + "."}}.dump(), "application/json");
+                    return;
+                }
+                std::optional<int> elegida;
+                if (input.contains("pick")) {
+                    elegida = input.at("pick").get<int>();
+                    if (*elegida < 0 || *elegida >= alternativas) {
+                        res.status = 400;
+                        res.set_content(json{{"error", "pick debe estar entre 0 y max_alternatives - 1."}}.dump(), "application/json");
+                        return;
+                    }
+                }
+                unsigned int semilla = seed ? *seed : static_cast<unsigned int>(time(nullptr));
+                AlgoritmoNSGA2 nsga(ajustado.problemas, problem_count, 100, 100, semilla);
+                auto soluciones = nsga.ejecutar(static_cast<size_t>(alternativas));
+                if (elegida && static_cast<size_t>(*elegida) >= soluciones.size()) {
+                    res.status = 400;
+                    res.set_content(json{{"error", "El frente solo tiene " + std::to_string(soluciones.size()) + " alternativas."}}.dump(), "application/json");
+                    return;
+                }
 
-            // Guardar la maratón generada en MongoDB
-            auto maratones_coll = db["Maratones"];
-            auto builder = document{};
-            auto array_builder = builder
-                << "nombre" << "Maraton Generada IA - " + std::to_string(time(0))
-                << "cantidadProblemas" << static_cast<int32_t>(problemas_optimizados.size())
-                << "createdAt" << bsoncxx::types::b_date{std::chrono::system_clock::now()}
-                << "participantes" << open_array << close_array // Array de participantes vacío
-                << "problemas" << open_array;
-
-            for(const auto& p : problemas_optimizados) {
-                array_builder << bsoncxx::oid{p.id};
+                json frente = json::array();
+                for (auto& s : soluciones) {
+                    if (!ajustado.tiemposOriginales.empty()) {
+                        restaurar_tiempos(ajustado, s.problemas);
+                        s.tiempoTotal = 0;
+                        for (const auto& p : s.problemas) s.tiempoTotal += p.tiempoPromedio;
+                    }
+                    json problemas = json::array();
+                    for (const auto& p : s.problemas) problemas.push_back(p.id.to_string());
+                    frente.push_back({{"problems", problemas},
+                                      {"total_time", s.tiempoTotal},
+                                      {"difficulty_spread", s.dispersion},
+                                      {"difficulty_levels", s.niveles}});
+                }
+
+                json respuesta{{"front", frente}, {"seed", semilla}};
+                res.status = 200;
+                if (elegida) {
+                    const auto& s = soluciones[static_cast<size_t>(*elegida)];
+                    bsoncxx::oid marathon_id;
+                    marathon_writer.submit(construir_maraton(marathon_id, s.problemas));
+                    reservation_index.reservar(marathon_id, s.problemas);
+                    respuesta["marathonId"] = marathon_id.to_string();
+                    respuesta["picked"] = *elegida;
+                    res.status = 201;
+                }
+                res.set_content(volcar_medido(respuesta), "application/json");
+                return;
+            }
+
+            // Peticiones idénticas sobre el mismo banco reutilizan el resultado
+            std::string variante = variante_motor(motor, opciones);
+            // Con reservas, la clave incluye su proyección sobre el banco
+            if (ajustado.huella) variante += "+" + reuso + "@" + std::to_string(ajustado.huella);
+            std::string cache_key = GenerateCache::clave(variante, difficulty, topics, problem_count, seed, banco.version);
+            std::vector<Problema> problemas_optimizados;
+            json respuesta;
+            if (auto cached = generate_cache.buscar(cache_key)) {
+                problemas_optimizados = std::move(*cached);
+                respuesta["cached"] = true;
+            } else {
+                // Ejecutar el motor elegido (algoritmo genético por defecto)
+                unsigned int semilla = seed ? *seed : static_cast<unsigned int>(time(nullptr));
+                auto resultado = crearOptimizador(motor, opciones)->optimizar(ajustado.problemas, Objetivo{problem_count}, semilla);
+                problemas_optimizados = std::move(resultado.problemas);
+                restaurar_tiempos(ajustado, problemas_optimizados);
+                respuesta["stats"] = estadisticas_json(motor, resultado.estadisticas);
+                generate_cache.guardar(cache_key, problemas_optimizados);
             }
-            
-            auto doc_final = array_builder << close_array << close_document;
-            
-            auto result = maratones_coll.insert_one(doc_final.view());
-            std::string new_marathon_id = result->inserted_id().get_oid().value.to_string();
+
+            // Guardar la maratón generada en MongoDB
+            bsoncxx::oid marathon_id;
+            marathon_writer.submit(construir_maraton(marathon_id, problemas_optimizados));
+            reservation_index.reservar(marathon_id, problemas_optimizados);
 
             // Devolver el ID de la nueva maratón
             res.status = 201;
-            res.set_content(json{{"marathonId", new_marathon_id}}.dump(), "application/json");
+            respuesta["marathonId"] = marathon_id.to_string();
+            res.set_content(volcar_medido(respuesta), "application/json");
 
         } catch (const json::parse_error& e) {
             res.status = 400; // Bad Request
             res.set_content(json{{"error", "JSON de entrada inválido: " + std::string(e.what())}}.dump(), "application/json");
+        } catch (const DBConnection::PoolTimeout& e) {
+            res.status = 503; // Service Unavailable
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
         } catch (const std::exception& e) {
             res.status = 500; // Internal Server Error
             res.set_content(json{{"error", "Error interno del servidor: " + std::string(e.what())}}.dump(), "application/json");
         }
     });
 
+    // ENDPOINT: POST /generate/stream
+    // Mismo cuerpo que /generate (solo engine "ga"). Responde con Server-Sent
+    // Events: un evento "generation" por generación con el mejor fitness, el
+    // medio, la diversidad y los microsegundos transcurridos, y al final
+    // "done" con el id de la maratón (o "error"). Si el cliente se desconecta,
+    // el algoritmo se detiene y no se guarda nada.
+    router.Post("/generate/stream", [&](const httplib::Request& req, httplib::Response& res) {
+        try {
+            auto input = json::parse(req.body);
+            int problem_count = input.value("problem_count", 0);
+            std::optional<unsigned int> seed;
+            if (input.contains("seed")) seed = input.at("seed").get<unsigned int>();
+            std::string motor;
+            OpcionesGeneticas opciones;
+            auto error_motor = leer_motor(input, refinamiento_vigente(), motor, opciones);
+            std::string reuso = input.value("reuse", "allow");
+
+            if (problem_count <= 0) {
+                res.status = 400;
+                res.set_content(json{{"error", "problem_count debe ser mayor a 0."}}.dump(), "application/json");
+                return;
+            }
+            if (error_motor || motor != "ga") {
+                res.status = 400;
+                res.set_content(json{{"error", error_motor ? *error_motor : "El progreso solo está disponible para engine 'ga'."}}.dump(), "application/json");
+                return;
+            }
+            if (!reuso_valido(reuso)) {
+                res.status = 400;
+                res.set_content(json{{"error", "reuse debe ser 'allow', 'avoid' o 'forbid'."}}.dump(), "application/json");
+                return;
+            }
+
+            auto ajustado = aplicar_reservas(problem_bank.snapshot().problemas, reservation_index, reuso);
+            auto banco = ajustado.problemas;
+            if (banco->size() < static_cast<size_t>(problem_count)) {
+                bool por_reservas = reuso == "forbid";
+                res.status = por_reservas ? 409 : 400;
+                res.set_content(json{{"error", por_reservas ? "No hay suficientes problemas libres de maratones activas."
+                                                            : "No hay suficientes problemas en la base de datos."}}.dump(), "application/json");
+                return;
+            }
+
+            if (!tomar_sesion_stream()) {
+                res.status = 503; // Service Unavailable
+                res.set_content(json{{"error", "Demasiadas generaciones con progreso en curso."}}.dump(), "application/json");
+                return;
+            }
+            auto sesion = std::make_shared<SesionProgreso>();
+            opciones.telemetria = &sesion->canal;
+            unsigned int semilla = seed ? *seed : static_cast<unsigned int>(time(nullptr));
+            calculos_stream.lanzar(sesion, [sesion, opciones, banco, problem_count, semilla] {
+                try {
+                    sesion->resultado = crearOptimizador("ga", opciones)->optimizar(banco, Objetivo{problem_count}, semilla);
+                } catch (const std::exception& e) {
+                    sesion->error = e.what();
+                }
+                sesion->terminado.store(true, std::memory_order_release);
+                sesion->canal.cerrar();
+            });
+
+            res.set_header("Cache-Control", "no-cache");
+            res.set_chunked_content_provider(
+                "text/event-stream",
+                [sesion, ajustado, &marathon_writer, &reservation_index](size_t, httplib::DataSink& sink) {
+                    // Dormir hasta la siguiente generación o el final
+                    sesion->canal.esperar(std::chrono::seconds(5));
+                    // Leer terminado antes de vaciar el canal: así no se
+                    // pierden las últimas generaciones
+                    bool fin = sesion->terminado.load(std::memory_order_acquire);
+                    std::string salida;
+                    MuestraGeneracion m;
+                    while (sesion->canal.consumir(m)) {
+                        salida += evento_sse("generation", {{"generation", m.generacion},
+                                                            {"best_fitness", m.mejorFitness},
+                                                            {"mean_fitness", m.fitnessMedio},
+                                                            {"diversity", m.diversidad},
+                                                            {"elapsed_us", m.microsegundos}});
+                    }
+                    if (fin) {
+                        if (!sesion->error.empty()) {
+                            salida += evento_sse("error", {{"error", sesion->error}});
+                        } else {
+                            try {
+                                bsoncxx::oid marathon_id;
+                                restaurar_tiempos(ajustado, sesion->resultado.problemas);
+                                marathon_writer.submit(construir_maraton(marathon_id, sesion->resultado.problemas));
+                                reservation_index.reservar(marathon_id, sesion->resultado.problemas);
+                                json fin_json = {{"marathonId", marathon_id.to_string()},
+                                                 {"stats", estadisticas_json("ga", sesion->resultado.estadisticas)},
+                                                 {"dropped_samples", sesion->canal.perdidas()}};
+                                salida += evento_sse("done", fin_json);
+                            } catch (const std::exception& e) {
+                                salida += evento_sse("error", {{"error", e.what()}});
+                            }
+                        }
+                    }
+                    if (salida.empty() && !fin) {
+                        // Comentario SSE: detecta pronto si el cliente se fue
+                        salida = ": ping\n\n";
+                    }
+                    if (!salida.empty() && !sink.write(salida.data(), salida.size())) return false;
+                    if (fin) sink.done();
+                    return true;
+                },
+                [sesion](bool completo) {
+                    if (!completo) sesion->canal.cancelar();
+                });
+
+        } catch (const json::exception& e) {
+            res.status = 400; // Bad Request
+            res.set_content(json{{"error", "JSON de entrada inválido: " + std::string(e.what())}}.dump(), "application/json");
+        } catch (const DBConnection::PoolTimeout& e) {
+            res.status = 503; // Service Unavailable
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        } catch (const std::exception& e) {
+            res.status = 500; // Internal Server Error
+            res.set_content(json{{"error", "Error interno del servidor: " + std::string(e.what())}}.dump(), "application/json");
+        }
+    });
+
+    // ENDPOINT: POST /generate/batch
+    // Varias maratones sobre una sola lectura del banco, ejecutadas en paralelo.
+    // Entrada: {"specs": [{"problem_count": 5, ...}, ...], "no_overlap": false, "reuse": "allow"}
+    router.Post("/generate/batch", [&](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Content-Type", "application/json");
+
+        try {
+            auto input = json::parse(req.body);
+            auto specs = input.value("specs", json::array());
+            bool no_overlap = input.value("no_overlap", false);
+            std::string reuso = input.value("reuse", "allow");
+
+            if (!specs.is_array() || specs.empty() || specs.size() > MAX_BATCH_SPECS) {
+                res.status = 400;
+                res.set_content(json{{"error", "specs debe tener entre 1 y " + std::to_string(MAX_BATCH_SPECS) + " elementos."}}.dump(), "application/json");
+                return;
+            }
+            if (!reuso_valido(reuso)) {
+                res.status = 400;
+                res.set_content(json{{"error", "reuse debe ser 'allow', 'avoid' o 'forbid'."}}.dump(), "application/json");
+                return;
+            }
+
+            std::vector<int> counts;
+            std::vector<unsigned int> semillas;
+            std::vector<std::unique_ptr<Optimizador>> optimizadores;
+            Refinamiento refinamiento = refinamiento_vigente();
+            std::random_device rd;
+            size_t total = 0;
+            for (const auto& spec : specs) {
+                int problem_count = spec.value("problem_count", 0);
+                if (problem_count <= 0) {
+                    res.status = 400;
+                    res.set_content(json{{"error", "problem_count debe ser mayor a 0."}}.dump(), "application/json");
+                    return;
+                }
+                std::string motor;
+                OpcionesGeneticas opciones;
+                if (auto error_motor = leer_motor(spec, refinamiento, motor, opciones)) {
+                    res.status = 400;
+                    res.set_content(json{{"error", *error_motor}}.dump(), "application/json");
+                    return;
+                }
+                counts.push_back(problem_count);
+                optimizadores.push_back(crearOptimizador(motor, opciones));
+                semillas.push_back(spec.value("seed", static_cast<unsigned int>(rd())));
+                total += problem_count;
+            }
+
+            // Una sola lectura del banco, compartida por todas las ejecuciones
+            auto ajustado = aplicar_reservas(problem_bank.snapshot().problemas, reservation_index, reuso);
+            std::shared_ptr<const std::vector<Problema>> banco = ajustado.problemas;
+
+            size_t maximo = no_overlap ? total : static_cast<size_t>(*std::max_element(counts.begin(), counts.end()));
+            if (banco->size() < maximo) {
+                bool por_reservas = reuso == "forbid";
+                res.status = por_reservas ? 409 : 400;
+                res.set_content(json{{"error", por_reservas ? "No hay suficientes problemas libres de maratones activas."
+                                                            : "No hay suficientes problemas en la base de datos."}}.dump(), "application/json");
+                return;
+            }
+
+            // Sin solapamiento: el banco se reparte en porciones disjuntas, una
+            // por maratón y proporcional a su problem_count. Se reparte por
+            // turnos ponderados sobre el banco ordenado por tiempo, así cada
+            // porción recibe problemas de todo el rango y ninguna se queda
+            // solo con los caros. Cada porción tiene al menos problem_count.
+            std::vector<std::shared_ptr<const std::vector<Problema>>> bancos(counts.size(), banco);
+            if (no_overlap) {
+                std::vector<const Problema*> orden;
+                orden.reserve(banco->size());
+                for (const auto& p : *banco) orden.push_back(&p);
+                std::stable_sort(orden.begin(), orden.end(), [](const Problema* a, const Problema* b) {
+                    return a->tiempoPromedio < b->tiempoPromedio;
+                });
+                std::vector<std::shared_ptr<std::vector<Problema>>> porciones;
+                for (int c : counts) {
+                    porciones.push_back(std::make_shared<std::vector<Problema>>());
+                    porciones.back()->reserve(banco->size() * c / total + 1);
+                }
+                std::vector<int64_t> credito(counts.size(), 0);
+                for (const Problema* p : orden) {
+                    size_t elegido = 0;
+                    for (size_t i = 0; i < counts.size(); ++i) {
+                        credito[i] += counts[i];
+                        if (credito[i] > credito[elegido]) elegido = i;
+                    }
+                    credito[elegido] -= static_cast<int64_t>(total);
+                    porciones[elegido]->push_back(*p);
+                }
+                for (size_t i = 0; i < counts.size(); ++i) bancos[i] = std::move(porciones[i]);
+            }
+
+            // Ejecutar los algoritmos en paralelo (un hilo por núcleo)
+            std::vector<std::vector<Problema>> resultados(counts.size());
+            std::vector<std::exception_ptr> errores(counts.size());
+            std::atomic<size_t> siguiente{0};
+            size_t hilos = std::min<size_t>(counts.size(), std::max(1u, std::thread::hardware_concurrency()));
+            std::vector<std::thread> trabajadores;
+            for (size_t t = 0; t < hilos; ++t) {
+                trabajadores.emplace_back([&] {
+                    for (size_t i = siguiente++; i < counts.size(); i = siguiente++) {
+                        try {
+                            resultados[i] = optimizadores[i]->optimizar(bancos[i], Objetivo{counts[i]}, semillas[i]).problemas;
+                        } catch (...) {
+                            errores[i] = std::current_exception();
+                        }
+                    }
+                });
+            }
+            for (auto& t : trabajadores) t.join();
+            for (auto& e : errores) {
+                if (e) std::rethrow_exception(e);
+            }
+
+            // Guardar todas las maratones juntas
+            json ids = json::array();
+            std::vector<bsoncxx::document::value> docs;
+            docs.reserve(resultados.size());
+            for (auto& problemas : resultados) {
+                restaurar_tiempos(ajustado, problemas);
+                bsoncxx::oid marathon_id;
+                docs.push_back(construir_maraton(marathon_id, problemas));
+                reservation_index.reservar(marathon_id, problemas);
+                ids.push_back(marathon_id.to_string());
+            }
+            marathon_writer.submitMany(std::move(docs));
+
+            res.status = 201;
+            res.set_content(volcar_medido(json{{"marathonIds", ids}}), "application/json");
+
+        } catch (const json::exception& e) {
+            res.status = 400; // Bad Request
+            res.set_content(json{{"error", "JSON de entrada inválido: " + std::string(e.what())}}.dump(), "application/json");
+        } catch (const DBConnection::PoolTimeout& e) {
+            res.status = 503; // Service Unavailable
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        } catch (const std::exception& e) {
+            res.status = 500; // Internal Server Error
+            res.set_content(json{{"error", "Error interno del servidor: " + std::string(e.what())}}.dump(), "application/json");
+        }
+    });
+
+    // ENDPOINT: POST /optimizers/benchmark
+    // Corre todos los motores con las mismas semillas sobre el banco vigente,
+    // para elegir el más barato que alcance la calidad buscada. No guarda nada.
+    // Entrada: {"problem_count": 10, "runs": 5, "seed": 1}
+    router.Post("/optimizers/benchmark", [&](const httplib::Request& req, httplib::Response& res) {
+        res.set_header("Content-Type", "application/json");
+
+        try {
+            auto input = json::parse(req.body);
+            int problem_count = input.value("problem_count", 0);
+            int runs = input.value("runs", 5);
+            unsigned int seed = input.value("seed", 1u);
+            if (problem_count <= 0 || runs <= 0 || runs > 100) {
+                res.status = 400;
+                res.set_content(json{{"error", "problem_count debe ser mayor a 0 y runs estar entre 1 y 100."}}.dump(), "application/json");
+                return;
+            }
+
+            std::shared_ptr<const std::vector<Problema>> banco = problem_bank.snapshot().problemas;
+            if (banco->size() < static_cast<size_t>(problem_count)) {
+                res.status = 400;
+                res.set_content(json{{"error", "No hay suficientes problemas en la base de datos."}}.dump(), "application/json");
+                return;
+            }
+
+            OpcionesGeneticas opciones;
+            opciones.refinamiento = refinamiento_vigente();
+            json motores = json::array();
+            for (const auto& motor : motoresDisponibles()) {
+                auto optimizador = crearOptimizador(motor, opciones);
+                int64_t mejor = std::numeric_limits<int64_t>::max();
+                double costo = 0.0, ms = 0.0, evaluaciones = 0.0;
+                for (int r = 0; r < runs; ++r) {
+                    auto e = optimizador->optimizar(banco, Objetivo{problem_count}, seed + r).estadisticas;
+                    mejor = std::min(mejor, e.costo);
+                    costo += e.costo;
+                    ms += e.milisegundos;
+                    evaluaciones += e.evaluaciones;
+                }
+                motores.push_back({{"engine", motor}, {"best_cost", mejor}, {"mean_cost", costo / runs},
+                                   {"mean_ms", ms / runs}, {"mean_evaluations", evaluaciones / runs}});
+            }
+            res.set_content(volcar_medido(json{{"problem_count", problem_count}, {"runs", runs}, {"engines", motores}}), "application/json");
+
+        } catch (const json::exception& e) {
+            res.status = 400; // Bad Request
+            res.set_content(json{{"error", "JSON de entrada inválido: " + std::string(e.what())}}.dump(), "application/json");
+        } catch (const DBConnection::PoolTimeout& e) {
+            res.status = 503; // Service Unavailable
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        } catch (const std::exception& e) {
+            res.status = 500; // Internal Server Error
+            res.set_content(json{{"error", "Error interno del servidor: " + std::string(e.what())}}.dump(), "application/json");
+        }
+    });
+
+    // ENDPOINTS del índice de reservas
+    router.Get("/reservations/stats", [&](const httplib::Request& req, httplib::Response& res) {
+        json stats = {
+            {"active_marathons", reservation_index.maratonesActivas()},
+            {"reserved_problems", reservation_index.problemasReservados()},
+            {"version", reservation_index.version()}
+        };
+        res.set_content(stats.dump(), "application/json");
+    });
+
+    // Llamar al cerrar o borrar una maratón fuera de este servidor
+    router.Delete("/reservations/{str}", [&](const httplib::Request& req, httplib::Response& res, const RouteParams& ruta) {
+        if (!autorizar_admin(req, res)) return;
+        bsoncxx::oid maraton;
+        try {
+            maraton = bsoncxx::oid(ruta.str(0));
+        } catch (const std::exception&) {
+            res.status = 400;
+            res.set_content(json{{"error", "Id de maratón inválido."}}.dump(), "application/json");
+            return;
+        }
+        if (!reservation_index.liberar(maraton)) {
+            res.status = 404;
+            res.set_content(json{{"error", "La maratón no está en el índice de reservas."}}.dump(), "application/json");
+            return;
+        }
+        res.set_content(json{{"message", "Reservas de la maratón liberadas."}}.dump(), "application/json");
+    });
+
+    // Llamar cuando se crean, cierran o borran varias maratones fuera de este servidor
+    router.Post("/reservations/rebuild", [&](const httplib::Request& req, httplib::Response& res) {
+        if (!autorizar_admin(req, res)) return;
+        try {
+            reservation_index.reconstruir();
+            res.set_content(json{{"message", "Índice de reservas reconstruido."}}.dump(), "application/json");
+        } catch (const DBConnection::PoolTimeout& e) {
+            res.status = 503; // Service Unavailable
+            res.set_content(json{{"error", e.what()}}.dump(), "application/json");
+        } catch (const std::exception& e) {
+            res.status = 500; // Internal Server Error
+            res.set_content(json{{"error", "Error interno del servidor: " + std::string(e.what())}}.dump(), "application/json");
+        }
+    });
+
+    // ENDPOINTS de la caché de /generate
+    router.Get("/cache/stats", [&](const httplib::Request& req, httplib::Response& res) {
+        json stats = {
+            {"hits", generate_cache.aciertos()},
+            {"misses", generate_cache.fallos()},
+            {"entries", generate_cache.tamano()}
+        };
+        auto gz = compressor.stats();
+        stats["compression"] = {
+            {"responses", gz.compressed},
+            {"cache_hits", gz.cacheHits},
+            {"cache_entries", gz.cacheEntries},
+            {"cache_bytes", gz.cacheBytes},
+            {"bytes_in", gz.bytesIn},
+            {"bytes_out", gz.bytesOut}
+        };
+        res.set_content(stats.dump(), "application/json");
+    });
+
+    // Llamar cuando cambian los problemas: fuerza releer el banco y vacía la caché
+    router.Post("/cache/invalidate", [&](const httplib::Request& req, httplib::Response& res) {
+        if (!autorizar_admin(req, res)) return;
+        problem_bank.invalidate();
+        generate_cache.limpiar();
+        res.set_content(json{{"message", "Caché invalidada."}}.dump(), "application/json");
+    });
+
     // ENDPOINTS CRUD de ejemplo para /config
-    svr.Get("/config", [&](const httplib::Request& req, httplib::Response& res) {
-        json config = {{"population_size", 100}, {"mutation_rate", 0.25}, {"crossover_rate", 0.85}};
+    // Solo local_search es real; el resto de parámetros siguen simulados.
+    router.Get("/config", [&](const httplib::Request& req, httplib::Response& res) {
+        Refinamiento refinamiento = refinamiento_vigente();
+        json config = {{"population_size", 100}, {"mutation_rate", 0.25}, {"crossover_rate", 0.85},
+                       {"local_search", {{"top_k", refinamiento.topK}, {"max_steps", refinamiento.maxPasos}}}};
         res.set_content(config.dump(), "application/json");
     });
 
-    svr.Put("/config", [&](const httplib::Request& req, httplib::Response& res) {
-        res.set_content(json{{"message", "Configuración actualizada (simulado)."}}.dump(), "application/json");
+    router.Put("/config", [&](const httplib::Request& req, httplib::Response& res) {
+        if (!autorizar_admin(req, res)) return;
+        try {
+            auto input = json::parse(req.body);
+            if (input.contains("local_search")) {
+                const auto& ls = input.at("local_search");
+                std::lock_guard<std::mutex> lock(refinamiento_mutex);
+                Refinamiento nuevo = refinamiento_actual;
+                nuevo.topK = ls.value("top_k", nuevo.topK);
+                nuevo.maxPasos = ls.value("max_steps", nuevo.maxPasos);
+                if (!nuevo.valido()) {
+                    res.status = 400;
+                    res.set_content(json{{"error", "top_k debe estar entre 0 y " + std::to_string(Refinamiento::MAX_TOP_K) +
+                                                   " y max_steps entre 0 y " + std::to_string(Refinamiento::MAX_PASOS) + "."}}.dump(), "application/json");
+                    return;
+                }
+                refinamiento_actual = nuevo;
+            }
+            res.set_content(json{{"message", "Configuración actualizada."}}.dump(), "application/json");
+        } catch (const json::exception& e) {
+            res.status = 400; // Bad Request
+            res.set_content(json{{"error", "JSON de entrada inválido: " + std::string(e.what())}}.dump(), "application/json");
+        }
     });
     
     // ENDPOINT: POST /optimize/:marathon_id
-    svr.Post(R"(/optimize/(\w+))", [&](const httplib::Request& req, httplib::Response& res) {
-        std::string marathon_id = req.matches[1].str();
+    router.Post("/optimize/{str}", [&](const httplib::Request&, httplib::Response& res, const RouteParams& ruta) {
+        std::string marathon_id = ruta.str(0);
         res.set_content(json{{"message", "Maratón " + marathon_id + " optimizada (simulado)."}}.dump(), "application/json");
     });
 
+    // ENDPOINT: GET /metrics (formato Prometheus)
+    // Rutas y fases se registran solas; aquí los gauges de ocupación
+    metrics::gauge("http_worker_threads", "Hilos del pool HTTP.",
+                   [] { return static_cast<double>(taskQueueStats().threads); });
+    metrics::gauge("http_worker_busy", "Hilos del pool atendiendo una conexión.",
+                   [] { return static_cast<double>(taskQueueStats().busy); });
+    metrics::gauge("http_queue_pending", "Conexiones esperando un hilo libre.",
+                   [] { return static_cast<double>(taskQueueStats().pending); });
+    metrics::gauge("http_queue_rejected", "Conexiones descartadas por cola llena desde el arranque.",
+                   [] { return static_cast<double>(taskQueueStats().rejected); });
+    metrics::gauge("generate_cache_entries", "Resultados guardados en la caché de /generate.",
+                   [&] { return static_cast<double>(generate_cache.tamano()); });
+    metrics::gauge("reservations_active_marathons", "Maratones activas en el índice de reservas.",
+                   [&] { return static_cast<double>(reservation_index.maratonesActivas()); });
+    metrics::gauge("generate_stream_sessions", "Generaciones con progreso (/generate/stream) en curso.",
+                   [] { return static_cast<double>(sesiones_stream.load(std::memory_order_relaxed)); });
+    router.Get("/metrics", [](const httplib::Request&, httplib::Response& res) {
+        res.set_content(metrics::renderPrometheus(), "text/plain; version=0.0.4");
+    });
+
     // Iniciar el servidor en el puerto 8080 para no chocar con Node.js (5050)
     int port = 8080;
     std::cout << "Servidor C++ escuchando en http://localhost:" << port << std::endl;
-    svr.listen("0.0.0.0", port);
+
+    // Ctrl+C / SIGTERM detienen el servidor para vaciar la cola de escritura
+    running_servers = &servers;
+    auto stop = [](int) { if (running_servers) running_servers->stop(); };
+    std::signal(SIGINT, stop);
+    std::signal(SIGTERM, stop);
+
+    servers.each([&](httplib::Server& svr) {
+        router.install(svr);
+        compressor.install(svr);
+    });
+    servers.listen("0.0.0.0", port);
+
+    // Los cálculos de /generate/stream que sigan vivos se cancelan antes de
+    // cerrar la cola de escritura
+    calculos_stream.cancelarYEsperar();
+    std::cout << "Guardando maratones pendientes..." << std::endl;
+    marathon_writer.shutdown();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,334 @@
+#include "marathon_writer.h"
+#include "db_connection.h"
+#include "metrics.h"
+#include <bsoncxx/json.hpp>
+#include <bsoncxx/types.hpp>
+#include <mongocxx/exception/bulk_write_exception.hpp>
+#include <mongocxx/exception/exception.hpp>
+#include <mongocxx/options/insert.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+const metrics::SeriesId FASE_DB = metrics::phase("db");
+
+size_t env_size(const char* name, size_t def) {
+    const char* v = std::getenv(name);
+    if (!v || !*v) return def;
+    try {
+        return static_cast<size_t>(std::stoull(v));
+    } catch (...) {
+        std::cerr << "Valor inválido para " << name << ": " << v << std::endl;
+        return def;
+    }
+}
+
+constexpr int MAX_RETRIES = 3;
+constexpr int DUPLICATE_KEY = 11000;
+
+// Índices del lote que el servidor rechazó. Una clave duplicada no cuenta:
+// el _id lo genera este servidor, así que el documento ya estaba guardado
+// (un intento anterior que sí llegó, o un reintento del derrame).
+// nullopt si la respuesta no detalla los documentos (red, write concern...)
+// y cualquiera pudo fallar.
+std::optional<std::vector<size_t>> rechazados(const mongocxx::bulk_write_exception& e) {
+    const auto& raw = e.raw_server_error();
+    if (!raw) return std::nullopt;
+    auto view = raw->view();
+    if (view["writeConcernErrors"]) return std::nullopt;
+    auto errores = view["writeErrors"];
+    if (!errores || errores.type() != bsoncxx::type::k_array) return std::nullopt;
+    std::vector<size_t> out;
+    for (const auto& err : errores.get_array().value) {
+        if (err["code"].get_int32().value == DUPLICATE_KEY) continue;
+        out.push_back(static_cast<size_t>(err["index"].get_int32().value));
+    }
+    return out;
+}
+
+std::string linea(bsoncxx::document::view doc) {
+    // Canónico para conservar ObjectId, fechas y tipos enteros al releerlo
+    return bsoncxx::to_json(doc, bsoncxx::ExtendedJsonMode::k_canonical);
+}
+}
+
+MarathonWriter::Config MarathonWriter::Config::fromEnv() {
+    Config cfg;
+    if (const char* d = std::getenv("MARATHON_DURABILITY")) {
+        std::string mode(d);
+        if (mode == "sync") cfg.durability = Durability::Sync;
+        else if (mode == "batched") cfg.durability = Durability::Batched;
+        else if (mode == "write-behind") cfg.durability = Durability::WriteBehind;
+        else std::cerr << "MARATHON_DURABILITY desconocida: " << mode << std::endl;
+    }
+    cfg.queueMax = env_size("MARATHON_QUEUE_MAX", cfg.queueMax);
+    cfg.batchSize = env_size("MARATHON_BATCH_SIZE", cfg.batchSize);
+    cfg.flushInterval = std::chrono::milliseconds(env_size("MARATHON_FLUSH_MS", cfg.flushInterval.count()));
+    if (const char* p = std::getenv("MARATHON_SPILL_PATH"); p && *p) cfg.spillPath = p;
+    cfg.spillRetry = std::chrono::seconds(env_size("MARATHON_SPILL_RETRY_S", cfg.spillRetry.count()));
+    if (cfg.batchSize == 0) cfg.batchSize = 1;
+    return cfg;
+}
+
+MarathonWriter::MarathonWriter(const Config& cfg) : cfg(cfg) {
+    if (cfg.durability != Durability::Sync) {
+        // Lo derramado en una ejecución anterior se reintenta al arrancar
+        std::error_code ec;
+        spilled = std::filesystem::exists(cfg.spillPath, ec);
+        lastSpillRetry = std::chrono::steady_clock::now() - cfg.spillRetry;
+        worker = std::thread([this] { run(); });
+    }
+}
+
+MarathonWriter::~MarathonWriter() {
+    shutdown();
+}
+
+void MarathonWriter::submit(bsoncxx::document::value doc) {
+    if (cfg.durability == Durability::Sync) {
+        insertOne(doc);
+        return;
+    }
+
+    std::future<void> done;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (stopping || queue.size() >= cfg.queueMax) {
+            // Contrapresión: sin espacio en la cola se escribe aquí mismo
+            lock.unlock();
+            insertOne(doc);
+            return;
+        }
+        queue.push_back({std::move(doc), std::promise<void>{}});
+        if (cfg.durability == Durability::Batched) {
+            done = queue.back().done.get_future();
+        }
+        if (queue.size() >= cfg.batchSize) cond.notify_one();
+    }
+    // En modo Batched propaga el error de escritura a la petición
+    if (done.valid()) done.get();
+}
+
+void MarathonWriter::submitMany(std::vector<bsoncxx::document::value> docs) {
+    if (docs.empty()) return;
+    if (cfg.durability == Durability::Sync) {
+        insertMany(docs);
+        return;
+    }
+
+    std::vector<std::future<void>> done;
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (stopping || queue.size() + docs.size() > cfg.queueMax) {
+            lock.unlock();
+            insertMany(docs);
+            return;
+        }
+        for (auto& doc : docs) {
+            queue.push_back({std::move(doc), std::promise<void>{}});
+            if (cfg.durability == Durability::Batched) {
+                done.push_back(queue.back().done.get_future());
+            }
+        }
+        if (queue.size() >= cfg.batchSize) cond.notify_one();
+    }
+    for (auto& f : done) f.get();
+}
+
+void MarathonWriter::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) return;
+        stopping = true;
+    }
+    cond.notify_one();
+    if (worker.joinable()) worker.join();
+}
+
+void MarathonWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        // Esperar a un lote completo, al intervalo de vaciado o al apagado
+        cond.wait_for(lock, cfg.flushInterval, [&] {
+            return stopping || queue.size() >= cfg.batchSize;
+        });
+        if (spilled && !stopping &&
+            std::chrono::steady_clock::now() - lastSpillRetry >= cfg.spillRetry) {
+            lock.unlock();
+            retrySpilled();
+            lock.lock();
+        }
+        if (queue.empty()) {
+            if (stopping) break;
+            continue;
+        }
+
+        std::deque<Pending> batch;
+        size_t n = std::min(queue.size(), cfg.batchSize);
+        std::move(queue.begin(), queue.begin() + n, std::back_inserter(batch));
+        queue.erase(queue.begin(), queue.begin() + n);
+
+        lock.unlock();
+        writeBatch(batch);
+        lock.lock();
+    }
+}
+
+void MarathonWriter::writeBatch(std::deque<Pending>& batch) {
+    std::vector<bsoncxx::document::view> docs;
+    docs.reserve(batch.size());
+    for (const auto& p : batch) docs.push_back(p.doc.view());
+
+    std::vector<size_t> fallidos;
+    std::exception_ptr error = insertWithRetries(docs, fallidos);
+
+    std::vector<bool> fallo(batch.size(), false);
+    for (size_t i : fallidos) fallo[i] = true;
+    std::vector<bsoncxx::document::view> perdidos;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        if (!fallo[i]) {
+            batch[i].done.set_value();
+        } else if (cfg.durability == Durability::Batched) {
+            // La petición sigue esperando: el error le llega como 500
+            batch[i].done.set_exception(error);
+        } else {
+            perdidos.push_back(docs[i]);
+        }
+    }
+    if (!perdidos.empty()) spill(perdidos);
+}
+
+std::exception_ptr MarathonWriter::insertWithRetries(const std::vector<bsoncxx::document::view>& docs,
+                                                     std::vector<size_t>& fallidos) {
+    std::vector<size_t> pendientes(docs.size());
+    std::iota(pendientes.begin(), pendientes.end(), size_t{0});
+
+    std::exception_ptr error;
+    for (int attempt = 1; attempt <= MAX_RETRIES && !pendientes.empty(); ++attempt) {
+        std::vector<bsoncxx::document::view> lote;
+        lote.reserve(pendientes.size());
+        for (size_t i : pendientes) lote.push_back(docs[i]);
+        try {
+            metrics::ScopedTimer timer(FASE_DB);
+            auto client = DBConnection::acquire();
+            auto db = DBConnection::get_db(*client);
+            mongocxx::options::insert opts;
+            opts.ordered(false);
+            db["Maratones"].insert_many(lote, opts);
+            pendientes.clear();
+            error = nullptr;
+            break;
+        } catch (const mongocxx::bulk_write_exception& e) {
+            // Con ordered(false) el servidor intenta todo el lote; solo se
+            // reintentan los documentos que rechazó
+            error = std::current_exception();
+            if (auto idx = rechazados(e)) {
+                std::vector<size_t> quedan;
+                for (size_t j : *idx) {
+                    if (j < pendientes.size()) quedan.push_back(pendientes[j]);
+                }
+                pendientes = std::move(quedan);
+            }
+            std::cerr << "Error guardando " << lote.size() << " maratones (intento "
+                      << attempt << "/" << MAX_RETRIES << "): " << e.what() << std::endl;
+        } catch (const std::exception& e) {
+            error = std::current_exception();
+            std::cerr << "Error guardando " << lote.size() << " maratones (intento "
+                      << attempt << "/" << MAX_RETRIES << "): " << e.what() << std::endl;
+        }
+        if (pendientes.empty()) {
+            error = nullptr;
+        } else if (attempt < MAX_RETRIES) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100 * attempt));
+        }
+    }
+    fallidos = std::move(pendientes);
+    return error;
+}
+
+void MarathonWriter::spill(const std::vector<bsoncxx::document::view>& docs) {
+    std::ofstream out(cfg.spillPath, std::ios::app);
+    for (const auto& d : docs) out << linea(d) << '\n';
+    out.flush();
+    if (!out) {
+        std::cerr << "No se pudo escribir " << cfg.spillPath << ": se pierden "
+                  << docs.size() << " maratones ya confirmadas al cliente." << std::endl;
+        return;
+    }
+    std::cerr << docs.size() << " maratones sin guardar pasan a " << cfg.spillPath
+              << "; se reintentan cada " << cfg.spillRetry.count() << "s." << std::endl;
+    spilled = true;
+}
+
+void MarathonWriter::retrySpilled() {
+    lastSpillRetry = std::chrono::steady_clock::now();
+    std::ifstream in(cfg.spillPath);
+    if (!in) {
+        spilled = false;
+        return;
+    }
+    std::vector<bsoncxx::document::value> docs;
+    std::vector<std::string> ilegibles;
+    std::string l;
+    while (std::getline(in, l)) {
+        if (l.empty()) continue;
+        try {
+            docs.push_back(bsoncxx::from_json(l));
+        } catch (const std::exception& e) {
+            // Se conserva tal cual para revisarla a mano
+            std::cerr << "Línea ilegible en " << cfg.spillPath << ": " << e.what() << std::endl;
+            ilegibles.push_back(l);
+        }
+    }
+    in.close();
+
+    std::vector<bsoncxx::document::view> views;
+    views.reserve(docs.size());
+    for (const auto& d : docs) views.push_back(d.view());
+    std::vector<size_t> fallidos;
+    if (!views.empty()) insertWithRetries(views, fallidos);
+
+    // Reescribir solo lo que sigue sin guardarse; el rename es atómico, así
+    // que un corte a mitad deja el archivo anterior (los duplicados se toleran)
+    std::error_code ec;
+    if (fallidos.empty() && ilegibles.empty()) {
+        std::filesystem::remove(cfg.spillPath, ec);
+        spilled = false;
+        std::cerr << "Maratones derramadas guardadas: " << views.size() << "." << std::endl;
+        return;
+    }
+    std::string tmp = cfg.spillPath + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        for (size_t i : fallidos) out << linea(views[i]) << '\n';
+        for (const auto& x : ilegibles) out << x << '\n';
+        if (!out.flush()) return; // se reintenta con el archivo original
+    }
+    std::filesystem::rename(tmp, cfg.spillPath, ec);
+    if (ec) std::cerr << "No se pudo reemplazar " << cfg.spillPath << ": " << ec.message() << std::endl;
+}
+
+void MarathonWriter::insertOne(const bsoncxx::document::value& doc) {
+    metrics::ScopedTimer timer(FASE_DB);
+    auto client = DBConnection::acquire();
+    auto db = DBConnection::get_db(*client);
+    db["Maratones"].insert_one(doc.view());
+}
+
+void MarathonWriter::insertMany(const std::vector<bsoncxx::document::value>& docs) {
+    std::vector<bsoncxx::document::view> views;
+    views.reserve(docs.size());
+    for (const auto& d : docs) views.push_back(d.view());
+    metrics::ScopedTimer timer(FASE_DB);
+    auto client = DBConnection::acquire();
+    auto db = DBConnection::get_db(*client);
+    db["Maratones"].insert_many(views);
+}
@@ -0,0 +1,92 @@
+#ifndef MARATHON_WRITER_H
+#define MARATHON_WRITER_H
+
+#include <bsoncxx/document/value.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Persistencia diferida de las maratones generadas.
+// El _id de la maratón lo genera el servidor, así que se puede responder al
+// cliente sin esperar a MongoDB. Los documentos pendientes se guardan en una
+// cola acotada y un hilo los escribe con insert_many por lotes.
+//
+// En WriteBehind el cliente ya recibió el id: si un lote agota los
+// reintentos, los documentos que no se guardaron se anexan al archivo de
+// derrame (JSON extendido, uno por línea) y el mismo hilo los reintenta cada
+// spillRetry, también tras reiniciar el servidor. Solo se pierden si no se
+// puede escribir ese archivo.
+class MarathonWriter {
+public:
+    enum class Durability {
+        Sync,       // insert_one antes de responder (comportamiento original)
+        Batched,    // se espera a que el lote que lo contiene se escriba
+        WriteBehind // se responde de inmediato; se escribe en segundo plano
+    };
+
+    struct Config {
+        Durability durability = Durability::WriteBehind; // MARATHON_DURABILITY
+        size_t queueMax = 1024;                            // MARATHON_QUEUE_MAX
+        size_t batchSize = 64;                             // MARATHON_BATCH_SIZE
+        std::chrono::milliseconds flushInterval{50};       // MARATHON_FLUSH_MS
+        std::string spillPath = "maratones_pendientes.jsonl"; // MARATHON_SPILL_PATH
+        std::chrono::seconds spillRetry{30};               // MARATHON_SPILL_RETRY_S
+
+        static Config fromEnv();
+    };
+
+    explicit MarathonWriter(const Config& cfg);
+    ~MarathonWriter();
+
+    MarathonWriter(const MarathonWriter&) = delete;
+    MarathonWriter& operator=(const MarathonWriter&) = delete;
+
+    // Persiste el documento según la durabilidad configurada. Si la cola está
+    // llena se escribe de forma síncrona en el hilo que llama.
+    void submit(bsoncxx::document::value doc);
+
+    // Igual que submit para varias maratones; sin cola se escriben con un
+    // único insert_many.
+    void submitMany(std::vector<bsoncxx::document::value> docs);
+
+    // Escribe todo lo pendiente y detiene el hilo de escritura. Se llama al
+    // apagar el servidor; submit posteriores se escriben de forma síncrona.
+    void shutdown();
+
+    const Config& config() const { return cfg; }
+
+private:
+    struct Pending {
+        bsoncxx::document::value doc;
+        std::promise<void> done; // solo se espera en modo Batched
+    };
+
+    void run();
+    void writeBatch(std::deque<Pending>& batch);
+    // Inserta con reintentos; en `fallidos` quedan los índices que no se
+    // guardaron y se devuelve el último error.
+    static std::exception_ptr insertWithRetries(const std::vector<bsoncxx::document::view>& docs,
+                                                std::vector<size_t>& fallidos);
+    void spill(const std::vector<bsoncxx::document::view>& docs);
+    void retrySpilled();
+    static void insertOne(const bsoncxx::document::value& doc);
+    static void insertMany(const std::vector<bsoncxx::document::value>& docs);
+
+    Config cfg;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<Pending> queue;
+    bool stopping = false;
+    std::thread worker;
+
+    // Solo los usa el hilo de escritura
+    bool spilled = false;
+    std::chrono::steady_clock::time_point lastSpillRetry;
+};
+
+#endif // MARATHON_WRITER_H
@@ -0,0 +1,88 @@
+#include "problem_bank.h"
+#include "db_connection.h"
+#include "metrics.h"
+#include <bsoncxx/builder/stream/document.hpp>
+#include <mongocxx/options/find.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using bsoncxx::builder::stream::document;
+using bsoncxx::builder::stream::finalize;
+
+namespace {
+// Lee el banco de problemas con solo los campos que usa el algoritmo.
+std::vector<Problema> cargar_problemas() {
+    static const metrics::SeriesId fase_db = metrics::phase("db");
+    metrics::ScopedTimer timer(fase_db);
+    auto client = DBConnection::acquire();
+    auto db = DBConnection::get_db(*client);
+    auto problemas_coll = db["Problemas"];
+    // TODO: Se puede expandir el filtro para usar difficulty y topics
+    document filter_builder{};
+
+    // Solo los campos que usa el algoritmo; el resto no viaja por la red
+    mongocxx::options::find find_opts;
+    find_opts.projection(document{} << "_id" << 1 << "tiempoPromedio" << 1
+                                    << "dificultad" << 1 << finalize);
+
+    std::vector<Problema> problemas;
+    for (const bsoncxx::document::view& doc : problemas_coll.find(filter_builder.view(), find_opts)) {
+        problemas.push_back({
+            doc["_id"].get_oid().value,
+            doc["tiempoPromedio"].get_int32().value,
+            doc["dificultad"].get_int32().value
+        });
+    }
+    return problemas;
+}
+
+// FNV-1a de 64 bits
+void fnv1a(uint64_t& h, const void* data, size_t len) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < len; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+}
+}
+
+ProblemBank::ProblemBank(std::chrono::seconds ttl) : ttl(ttl) {}
+
+std::chrono::seconds ProblemBank::ttlFromEnv() {
+    const char* v = std::getenv("BANK_TTL_SECONDS");
+    if (!v || !*v) return std::chrono::seconds(60);
+    try {
+        return std::chrono::seconds(std::stoll(v));
+    } catch (...) {
+        return std::chrono::seconds(60);
+    }
+}
+
+ProblemBank::Snapshot ProblemBank::snapshot() {
+    // Una sola lectura a la vez; las demás peticiones esperan y la reutilizan
+    std::lock_guard<std::mutex> lock(mutex);
+    auto ahora = std::chrono::steady_clock::now();
+    if (!valido || ahora - leido >= ttl) {
+        auto problemas = std::make_shared<const std::vector<Problema>>(cargar_problemas());
+        actual = {problemas, hashContenido(*problemas)};
+        leido = ahora;
+        valido = true;
+    }
+    return actual;
+}
+
+void ProblemBank::invalidate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    valido = false;
+}
+
+uint64_t ProblemBank::hashContenido(const std::vector<Problema>& problemas) {
+    uint64_t h = 14695981039346656037ULL;
+    for (const auto& p : problemas) {
+        fnv1a(h, p.id.bytes(), bsoncxx::oid::k_oid_length);
+        fnv1a(h, &p.tiempoPromedio, sizeof(p.tiempoPromedio));
+        fnv1a(h, &p.dificultad, sizeof(p.dificultad));
+    }
+    return h;
+}
@@ -0,0 +1,43 @@
+#ifndef PROBLEM_BANK_H
+#define PROBLEM_BANK_H
+
+#include "AlgoritmoGenetico.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Copia en memoria de la colección Problemas, compartida por todas las
+// peticiones. Se vuelve a leer cuando caduca (BANK_TTL_SECONDS) o cuando se
+// invalida explícitamente. La versión es un hash del contenido: si el banco
+// no cambió entre dos lecturas, la versión se mantiene.
+class ProblemBank {
+public:
+    struct Snapshot {
+        std::shared_ptr<const std::vector<Problema>> problemas;
+        uint64_t version = 0;
+    };
+
+    explicit ProblemBank(std::chrono::seconds ttl);
+
+    // TTL desde BANK_TTL_SECONDS (por defecto 60 s; 0 = leer siempre).
+    static std::chrono::seconds ttlFromEnv();
+
+    // Banco vigente; lo lee de MongoDB si hace falta.
+    Snapshot snapshot();
+
+    // Fuerza una nueva lectura en la próxima petición.
+    void invalidate();
+
+private:
+    static uint64_t hashContenido(const std::vector<Problema>& problemas);
+
+    std::chrono::seconds ttl;
+    std::mutex mutex;
+    Snapshot actual;
+    std::chrono::steady_clock::time_point leido{};
+    bool valido = false;
+};
+
+#endif // PROBLEM_BANK_H
@@ -0,0 +1,203 @@
+#include "reservation_index.h"
+#include "db_connection.h"
+#include "metrics.h"
+#include <bsoncxx/builder/stream/document.hpp>
+#include <bsoncxx/types.hpp>
+#include <mongocxx/options/find.hpp>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+using bsoncxx::builder::stream::document;
+using bsoncxx::builder::stream::open_document;
+using bsoncxx::builder::stream::close_document;
+using bsoncxx::builder::stream::finalize;
+
+namespace {
+inline int popcount64(uint64_t x) { return __builtin_popcountll(x); }
+}
+
+ReservationIndex::ReservationIndex(std::chrono::hours ventana) : ventana(ventana) {}
+
+std::chrono::hours ReservationIndex::windowFromEnv() {
+    const char* v = std::getenv("RESERVATION_WINDOW_DAYS");
+    if (!v || !*v) return std::chrono::hours(24 * 30);
+    try {
+        return std::chrono::hours(24 * std::stoll(v));
+    } catch (...) {
+        return std::chrono::hours(24 * 30);
+    }
+}
+
+void ReservationIndex::reconstruir() {
+    static const metrics::SeriesId fase_db = metrics::phase("db");
+    metrics::ScopedTimer timer(fase_db);
+    auto client = DBConnection::acquire();
+    auto db = DBConnection::get_db(*client);
+    auto maratones_coll = db["Maratones"];
+
+    document filter_builder{};
+    if (ventana.count() > 0) {
+        auto desde = std::chrono::system_clock::now() - ventana;
+        filter_builder << "createdAt" << open_document
+                       << "$gte" << bsoncxx::types::b_date{desde} << close_document;
+    }
+
+    mongocxx::options::find find_opts;
+    find_opts.projection(document{} << "_id" << 1 << "problemas" << 1 << "createdAt" << 1 << finalize);
+
+    // Leer fuera del lock y reemplazar el índice de una vez
+    struct Activa {
+        bsoncxx::oid maraton;
+        std::vector<bsoncxx::oid> ids;
+        Reloj::time_point creada;
+    };
+    std::vector<Activa> activas;
+    auto ahora = Reloj::now();
+    for (const bsoncxx::document::view& doc : maratones_coll.find(filter_builder.view(), find_opts)) {
+        auto problemas = doc["problemas"];
+        if (!problemas || problemas.type() != bsoncxx::type::k_array) continue;
+        std::vector<bsoncxx::oid> ids;
+        for (const auto& p : problemas.get_array().value) {
+            if (p.type() == bsoncxx::type::k_oid) ids.push_back(p.get_oid().value);
+        }
+        // Sin createdAt (solo posible con ventana 0) cuenta desde ahora
+        auto creada = doc["createdAt"];
+        Reloj::time_point cuando = ahora;
+        if (creada && creada.type() == bsoncxx::type::k_date) {
+            cuando = Reloj::time_point(std::chrono::duration_cast<Reloj::duration>(creada.get_date().value));
+        }
+        activas.push_back({doc["_id"].get_oid().value, std::move(ids), cuando});
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    slotDe.clear();
+    problemasDe.clear();
+    creadaEn.clear();
+    libres.clear();
+    porProblema.clear();
+    for (const auto& a : activas) reservarSinLock(a.maraton, a.ids, a.creada);
+    ver.fetch_add(1, std::memory_order_release);
+    std::cout << "Índice de reservas: " << slotDe.size() << " maratones activas, "
+              << porProblema.size() << " problemas reservados." << std::endl;
+}
+
+void ReservationIndex::reservar(const bsoncxx::oid& maraton, const std::vector<Problema>& problemas) {
+    std::vector<bsoncxx::oid> ids;
+    ids.reserve(problemas.size());
+    for (const auto& p : problemas) ids.push_back(p.id);
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    purgarVencidasSinLock();
+    reservarSinLock(maraton, ids, Reloj::now());
+    ver.fetch_add(1, std::memory_order_release);
+}
+
+bool ReservationIndex::liberar(const bsoncxx::oid& maraton) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    bool purgadas = purgarVencidasSinLock();
+    bool liberada = liberarSinLock(maraton);
+    if (purgadas || liberada) ver.fetch_add(1, std::memory_order_release);
+    return liberada;
+}
+
+void ReservationIndex::reservarSinLock(const bsoncxx::oid& maraton, const std::vector<bsoncxx::oid>& problemas,
+                                       Reloj::time_point creada) {
+    liberarSinLock(maraton); // volver a reservar reemplaza la anterior
+
+    size_t slot;
+    if (!libres.empty()) {
+        slot = libres.back();
+        libres.pop_back();
+        problemasDe[slot] = problemas;
+        creadaEn[slot] = creada;
+    } else {
+        slot = problemasDe.size();
+        problemasDe.push_back(problemas);
+        creadaEn.push_back(creada);
+    }
+    slotDe[maraton] = slot;
+
+    for (const auto& id : problemas) {
+        Bitmap& bits = porProblema[id];
+        if (bits.size() <= slot / 64) bits.resize(slot / 64 + 1, 0);
+        bits[slot / 64] |= uint64_t{1} << (slot % 64);
+    }
+}
+
+bool ReservationIndex::liberarSinLock(const bsoncxx::oid& maraton) {
+    auto it = slotDe.find(maraton);
+    if (it == slotDe.end()) return false;
+    size_t slot = it->second;
+    for (const auto& id : problemasDe[slot]) {
+        auto bits = porProblema.find(id);
+        if (bits == porProblema.end()) continue;
+        bits->second[slot / 64] &= ~(uint64_t{1} << (slot % 64));
+        bool vacio = true;
+        for (uint64_t w : bits->second) {
+            if (w) { vacio = false; break; }
+        }
+        if (vacio) porProblema.erase(bits);
+    }
+    problemasDe[slot].clear();
+    libres.push_back(slot);
+    slotDe.erase(it);
+    return true;
+}
+
+bool ReservationIndex::purgarVencidasSinLock() {
+    if (ventana.count() <= 0) return false;
+    auto limite = Reloj::now() - ventana;
+    std::vector<bsoncxx::oid> vencidas;
+    for (const auto& [maraton, slot] : slotDe) {
+        if (creadaEn[slot] < limite) vencidas.push_back(maraton);
+    }
+    for (const auto& maraton : vencidas) liberarSinLock(maraton);
+    return !vencidas.empty();
+}
+
+ReservationIndex::Bitmap ReservationIndex::vigentesSinLock() const {
+    Bitmap vigentes((problemasDe.size() + 63) / 64, 0);
+    auto limite = ventana.count() > 0 ? Reloj::now() - ventana : Reloj::time_point::min();
+    for (const auto& [maraton, slot] : slotDe) {
+        if (creadaEn[slot] >= limite) vigentes[slot / 64] |= uint64_t{1} << (slot % 64);
+    }
+    return vigentes;
+}
+
+std::vector<uint16_t> ReservationIndex::conteos(const std::vector<Problema>& banco) const {
+    std::vector<uint16_t> resultado(banco.size(), 0);
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (porProblema.empty()) return resultado;
+    // Las vencidas desde la última escritura no cuentan aunque sigan en el índice
+    Bitmap vigentes = vigentesSinLock();
+    for (size_t i = 0; i < banco.size(); ++i) {
+        auto it = porProblema.find(banco[i].id);
+        if (it == porProblema.end()) continue;
+        int n = 0;
+        for (size_t k = 0; k < it->second.size(); ++k) n += popcount64(it->second[k] & vigentes[k]);
+        resultado[i] = static_cast<uint16_t>(std::min(n, 0xFFFF));
+    }
+    return resultado;
+}
+
+size_t ReservationIndex::maratonesActivas() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    size_t n = 0;
+    for (uint64_t w : vigentesSinLock()) n += popcount64(w);
+    return n;
+}
+
+size_t ReservationIndex::problemasReservados() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    Bitmap vigentes = vigentesSinLock();
+    size_t n = 0;
+    for (const auto& [problema, bits] : porProblema) {
+        for (size_t k = 0; k < bits.size(); ++k) {
+            if (bits[k] & vigentes[k]) { ++n; break; }
+        }
+    }
+    return n;
+}
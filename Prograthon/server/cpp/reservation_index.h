@@ -0,0 +1,72 @@
+#ifndef RESERVATION_INDEX_H
+#define RESERVATION_INDEX_H
+
+#include "AlgoritmoGenetico.h"
+#include <bsoncxx/oid.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <shared_mutex>
+#include <vector>
+
+// Índice en memoria de qué problemas ya están en maratones activas, para
+// que el algoritmo evite (o prohíba) repetirlos sin consultar MongoDB.
+// Cada maratón activa ocupa una posición (slot) y cada problema guarda un
+// bitmap sobre esas posiciones. Se reconstruye desde Maratones al iniciar y
+// se actualiza al insertar; las lecturas concurrentes solo toman el lock
+// compartido.
+// Una maratón es activa si se creó dentro de la ventana
+// RESERVATION_WINDOW_DAYS (por defecto 30; 0 = sin límite). Cada posición
+// guarda su fecha de creación: las lecturas ignoran las vencidas y las
+// escrituras las liberan, sin esperar a reconstruir(). Las que se borran
+// fuera de este servidor siguen reservadas hasta DELETE /reservations/{id} o
+// POST /reservations/rebuild.
+class ReservationIndex {
+public:
+    explicit ReservationIndex(std::chrono::hours ventana);
+
+    static std::chrono::hours windowFromEnv();
+
+    // Vuelve a leer las maratones activas de MongoDB.
+    void reconstruir();
+
+    // Registra una maratón recién generada.
+    void reservar(const bsoncxx::oid& maraton, const std::vector<Problema>& problemas);
+
+    // Quita una maratón del índice (cerrada o eliminada). false si no estaba.
+    bool liberar(const bsoncxx::oid& maraton);
+
+    // Cuántas maratones activas usan cada problema del banco (misma
+    // posición). Así el algoritmo lo consulta en O(1) por índice.
+    std::vector<uint16_t> conteos(const std::vector<Problema>& banco) const;
+
+    // Cambia con cada reserva, liberación o reconstrucción.
+    uint64_t version() const { return ver.load(std::memory_order_acquire); }
+
+    size_t maratonesActivas() const;
+    size_t problemasReservados() const;
+
+private:
+    using Bitmap = std::vector<uint64_t>;
+    using Reloj = std::chrono::system_clock;
+
+    void reservarSinLock(const bsoncxx::oid& maraton, const std::vector<bsoncxx::oid>& problemas,
+                         Reloj::time_point creada);
+    bool liberarSinLock(const bsoncxx::oid& maraton);
+    // Libera las maratones que salieron de la ventana; true si había alguna.
+    bool purgarVencidasSinLock();
+    // Posiciones ocupadas y todavía dentro de la ventana.
+    Bitmap vigentesSinLock() const;
+
+    std::chrono::hours ventana;
+    mutable std::shared_mutex mutex;
+    std::map<bsoncxx::oid, size_t> slotDe;                       // maratón -> posición
+    std::vector<std::vector<bsoncxx::oid>> problemasDe;          // posición -> problemas
+    std::vector<Reloj::time_point> creadaEn;                     // posición -> createdAt
+    std::vector<size_t> libres;                                  // posiciones reutilizables
+    std::map<bsoncxx::oid, Bitmap> porProblema;                  // problema -> maratones
+    std::atomic<uint64_t> ver{0};
+};
+
+#endif // RESERVATION_INDEX_H
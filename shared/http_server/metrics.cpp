@@ -0,0 +1,316 @@
+#include "metrics.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+namespace metrics {
+namespace {
+// Buckets HDR: 0..7 µs exactos y luego 8 sub-buckets por potencia de dos
+// hasta 2^31 µs (~36 min); lo que pase de ahí cae en el último.
+constexpr int SUB_BUCKETS = 8;
+constexpr int OCTAVAS = 28;
+constexpr size_t BUCKETS = SUB_BUCKETS + OCTAVAS * SUB_BUCKETS;
+constexpr size_t CLASES = 5; // 1xx..5xx
+constexpr SeriesId OTRAS = MAX_SERIES - 1;
+
+// Límites "le" de Prometheus (segundos); se rellenan desde los buckets HDR
+constexpr std::array<double, 14> LIMITES = {
+    0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+constexpr std::array<double, 4> CUANTILES = {0.5, 0.9, 0.99, 0.999};
+
+struct Contadores {
+    std::atomic<uint64_t> clases[CLASES];
+    std::atomic<uint64_t> sumaNs;
+    std::atomic<uint64_t> buckets[BUCKETS];
+};
+
+// Todos los contadores de un hilo. Se crea con new Shard() para que los
+// atómicos empiecen en cero.
+struct Shard {
+    Contadores series[MAX_SERIES];
+};
+
+struct Serie {
+    bool esRuta;
+    std::string metodo;
+    std::string nombre;
+};
+
+struct Gauge {
+    std::string nombre;
+    std::string ayuda;
+    std::function<double()> leer;
+};
+
+struct Registro {
+    std::mutex mutex;
+    std::vector<Serie> series;
+    std::vector<Shard*> shards;
+    std::vector<Shard*> libres;
+    std::vector<Gauge> gauges;
+};
+
+// Nunca se destruye: los hilos pueden devolver su shard después de main()
+Registro& registro() {
+    static Registro* r = new Registro();
+    return *r;
+}
+
+// Devuelve el shard a la lista libre cuando termina el hilo
+struct ShardLocal {
+    Shard* shard = nullptr;
+    ~ShardLocal() {
+        if (!shard) return;
+        Registro& r = registro();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.libres.push_back(shard);
+    }
+};
+
+Shard& shardLocal() {
+    thread_local ShardLocal local;
+    if (!local.shard) {
+        Registro& r = registro();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (!r.libres.empty()) {
+            local.shard = r.libres.back();
+            r.libres.pop_back();
+        } else {
+            local.shard = new Shard();
+            r.shards.push_back(local.shard);
+        }
+    }
+    return *local.shard;
+}
+
+// Solo el hilo dueño escribe en su shard: no hace falta fetch_add
+inline void sumar(std::atomic<uint64_t>& c, uint64_t n) {
+    c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+size_t bucketDe(uint64_t us) {
+    if (us < SUB_BUCKETS) return static_cast<size_t>(us);
+    int k = 0;
+    for (uint64_t v = us; v > 1; v >>= 1) ++k;
+    if (k >= 3 + OCTAVAS) return BUCKETS - 1;
+    return SUB_BUCKETS + static_cast<size_t>(k - 3) * SUB_BUCKETS +
+           static_cast<size_t>((us >> (k - 3)) & (SUB_BUCKETS - 1));
+}
+
+// Rango [inferior, superior) en µs de un bucket
+uint64_t inferiorDe(size_t b) {
+    if (b < SUB_BUCKETS) return b;
+    size_t k = 3 + (b - SUB_BUCKETS) / SUB_BUCKETS;
+    return (SUB_BUCKETS + (b - SUB_BUCKETS) % SUB_BUCKETS) << (k - 3);
+}
+
+uint64_t superiorDe(size_t b) {
+    if (b < SUB_BUCKETS) return b + 1;
+    size_t k = 3 + (b - SUB_BUCKETS) / SUB_BUCKETS;
+    return (SUB_BUCKETS + 1 + (b - SUB_BUCKETS) % SUB_BUCKETS) << (k - 3);
+}
+
+void registrar(SeriesId id, uint64_t ns, int clase) {
+    Contadores& c = shardLocal().series[id];
+    if (clase >= 0) sumar(c.clases[clase], 1);
+    sumar(c.sumaNs, ns);
+    sumar(c.buckets[bucketDe(ns / 1000)], 1);
+}
+
+SeriesId alta(bool esRuta, const std::string& metodo, const std::string& nombre) {
+    Registro& r = registro();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (size_t i = 0; i < r.series.size(); ++i) {
+        const Serie& s = r.series[i];
+        if (s.esRuta == esRuta && s.metodo == metodo && s.nombre == nombre) {
+            return static_cast<SeriesId>(i);
+        }
+    }
+    if (r.series.size() >= OTRAS) return OTRAS;
+    r.series.push_back({esRuta, metodo, nombre});
+    return static_cast<SeriesId>(r.series.size() - 1);
+}
+
+// Suma de todos los shards para una serie
+struct Total {
+    uint64_t clases[CLASES] = {};
+    uint64_t sumaNs = 0;
+    uint64_t cuenta = 0;
+    std::vector<uint64_t> buckets = std::vector<uint64_t>(BUCKETS, 0);
+};
+
+Total totalDe(const Registro& r, SeriesId id) {
+    Total t;
+    for (const Shard* s : r.shards) {
+        const Contadores& c = s->series[id];
+        for (size_t i = 0; i < CLASES; ++i) t.clases[i] += c.clases[i].load(std::memory_order_relaxed);
+        t.sumaNs += c.sumaNs.load(std::memory_order_relaxed);
+        for (size_t b = 0; b < BUCKETS; ++b) t.buckets[b] += c.buckets[b].load(std::memory_order_relaxed);
+    }
+    for (uint64_t n : t.buckets) t.cuenta += n;
+    return t;
+}
+
+double cuantil(const Total& t, double q) {
+    if (t.cuenta == 0) return 0;
+    uint64_t objetivo = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(t.cuenta) + 0.5));
+    uint64_t acumulado = 0;
+    for (size_t b = 0; b < BUCKETS; ++b) {
+        acumulado += t.buckets[b];
+        if (acumulado >= objetivo) {
+            return (static_cast<double>(inferiorDe(b)) + static_cast<double>(superiorDe(b))) / 2e6;
+        }
+    }
+    return static_cast<double>(superiorDe(BUCKETS - 1)) / 1e6;
+}
+
+std::string numero(double v) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", v);
+    return buf;
+}
+
+std::string escapar(const std::string& s) {
+    std::string out;
+    out.reserve(s.size());
+    for (char ch : s) {
+        if (ch == '\\' || ch == '"') out += '\\';
+        if (ch == '\n') { out += "\\n"; continue; }
+        out += ch;
+    }
+    return out;
+}
+
+std::string etiquetas(const Serie& s) {
+    if (s.esRuta) return "method=\"" + escapar(s.metodo) + "\",route=\"" + escapar(s.nombre) + "\"";
+    return "phase=\"" + escapar(s.nombre) + "\"";
+}
+
+void histograma(std::string& out, const std::string& nombre, const std::string& lbl, const Total& t) {
+    // Un bucket HDR cuenta para "le" si todo su rango cabe debajo del límite
+    size_t b = 0;
+    uint64_t acumulado = 0;
+    for (double limite : LIMITES) {
+        auto limiteUs = static_cast<uint64_t>(limite * 1e6 + 0.5);
+        while (b < BUCKETS && superiorDe(b) - 1 <= limiteUs) acumulado += t.buckets[b++];
+        out += nombre + "_bucket{" + lbl + ",le=\"" + numero(limite) + "\"} " + std::to_string(acumulado) + "\n";
+    }
+    out += nombre + "_bucket{" + lbl + ",le=\"+Inf\"} " + std::to_string(t.cuenta) + "\n";
+    out += nombre + "_sum{" + lbl + "} " + numero(static_cast<double>(t.sumaNs) / 1e9) + "\n";
+    out += nombre + "_count{" + lbl + "} " + std::to_string(t.cuenta) + "\n";
+}
+
+void cuantiles(std::string& out, const std::string& nombre, const std::string& lbl, const Total& t) {
+    for (double q : CUANTILES) {
+        out += nombre + "{" + lbl + ",quantile=\"" + numero(q) + "\"} " + numero(cuantil(t, q)) + "\n";
+    }
+}
+}
+
+SeriesId route(const std::string& method, const std::string& pattern) {
+    return alta(true, method, pattern);
+}
+
+SeriesId phase(const std::string& name) {
+    return alta(false, "", name);
+}
+
+void recordRequest(SeriesId id, int status, uint64_t nanoseconds) {
+    int clase = std::min<int>(std::max<int>(status / 100, 1), 5) - 1;
+    registrar(id, nanoseconds, clase);
+}
+
+void recordPhase(SeriesId id, uint64_t nanoseconds) {
+    // Las fases que no cupieron en el registro no se miden
+    if (id == OTRAS) return;
+    registrar(id, nanoseconds, -1);
+}
+
+void gauge(const std::string& name, const std::string& help, std::function<double()> read) {
+    Registro& r = registro();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    for (auto& g : r.gauges) {
+        if (g.nombre == name) {
+            g.ayuda = help;
+            g.leer = std::move(read);
+            return;
+        }
+    }
+    r.gauges.push_back({name, help, std::move(read)});
+}
+
+std::string renderPrometheus() {
+    Registro& r = registro();
+    std::vector<Serie> series;
+    std::vector<Total> totales;
+    std::vector<Gauge> gauges;
+    {
+        std::lock_guard<std::mutex> lock(r.mutex);
+        series = r.series;
+        if (series.size() == OTRAS) series.push_back({true, "*", "other"});
+        totales.reserve(series.size());
+        for (size_t i = 0; i < series.size(); ++i) totales.push_back(totalDe(r, static_cast<SeriesId>(i)));
+        // Los gauges se leen fuera del mutex
+        gauges = r.gauges;
+    }
+
+    static const char* CLASE[CLASES] = {"1xx", "2xx", "3xx", "4xx", "5xx"};
+    std::string out;
+    out.reserve(16 * 1024);
+
+    out += "# HELP http_requests_total Peticiones atendidas por ruta y clase de estado.\n";
+    out += "# TYPE http_requests_total counter\n";
+    for (size_t i = 0; i < series.size(); ++i) {
+        if (!series[i].esRuta) continue;
+        std::string lbl = etiquetas(series[i]);
+        for (size_t c = 0; c < CLASES; ++c) {
+            if (totales[i].clases[c] == 0) continue;
+            out += "http_requests_total{" + lbl + ",code=\"" + CLASE[c] + "\"} " +
+                   std::to_string(totales[i].clases[c]) + "\n";
+        }
+    }
+
+    out += "# HELP http_request_duration_seconds Latencia de los handlers por ruta.\n";
+    out += "# TYPE http_request_duration_seconds histogram\n";
+    for (size_t i = 0; i < series.size(); ++i) {
+        if (series[i].esRuta && totales[i].cuenta > 0) {
+            histograma(out, "http_request_duration_seconds", etiquetas(series[i]), totales[i]);
+        }
+    }
+
+    out += "# HELP http_request_duration_quantile_seconds Cuantiles de latencia por ruta (HDR, desde el arranque).\n";
+    out += "# TYPE http_request_duration_quantile_seconds gauge\n";
+    for (size_t i = 0; i < series.size(); ++i) {
+        if (series[i].esRuta && totales[i].cuenta > 0) {
+            cuantiles(out, "http_request_duration_quantile_seconds", etiquetas(series[i]), totales[i]);
+        }
+    }
+
+    out += "# HELP app_phase_duration_seconds Tiempo por fase dentro de las peticiones.\n";
+    out += "# TYPE app_phase_duration_seconds histogram\n";
+    for (size_t i = 0; i < series.size(); ++i) {
+        if (!series[i].esRuta && totales[i].cuenta > 0) {
+            histograma(out, "app_phase_duration_seconds", etiquetas(series[i]), totales[i]);
+        }
+    }
+
+    out += "# HELP app_phase_duration_quantile_seconds Cuantiles por fase (HDR, desde el arranque).\n";
+    out += "# TYPE app_phase_duration_quantile_seconds gauge\n";
+    for (size_t i = 0; i < series.size(); ++i) {
+        if (!series[i].esRuta && totales[i].cuenta > 0) {
+            cuantiles(out, "app_phase_duration_quantile_seconds", etiquetas(series[i]), totales[i]);
+        }
+    }
+
+    for (const auto& g : gauges) {
+        out += "# HELP " + g.nombre + " " + g.ayuda + "\n";
+        out += "# TYPE " + g.nombre + " gauge\n";
+        out += g.nombre + " " + numero(g.leer ? g.leer() : 0) + "\n";
+    }
+    return out;
+}
+
+}
@@ -0,0 +1,57 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+// --- MÉTRICAS DEL SERVIDOR ---
+// Contadores por ruta (peticiones por clase de estado), histogramas de
+// latencia tipo HDR (log-lineales, 8 sub-buckets por potencia de dos, en
+// microsegundos) y tiempos por fase (auth, db, serialize, hash...).
+//
+// Cada hilo escribe en su propio shard de contadores atómicos sin
+// contención: solo el hilo dueño los modifica (load + store relajados) y el
+// scrape suma todos los shards. Cuando un hilo termina, su shard vuelve a
+// una lista libre y lo reutiliza el siguiente hilo, así que los totales no
+// se pierden. renderPrometheus() produce el formato de texto 0.0.4.
+namespace metrics {
+
+using SeriesId = uint16_t;
+
+// Capacidad de series (rutas + fases). La última se reserva para "other"
+// cuando se agota; registrar el mismo nombre dos veces devuelve el mismo id.
+constexpr size_t MAX_SERIES = 64;
+
+SeriesId route(const std::string& method, const std::string& pattern);
+SeriesId phase(const std::string& name);
+
+void recordRequest(SeriesId id, int status, uint64_t nanoseconds);
+void recordPhase(SeriesId id, uint64_t nanoseconds);
+
+// Mide la fase desde la construcción hasta el final del ámbito
+class ScopedTimer {
+public:
+    explicit ScopedTimer(SeriesId id) : id_(id), inicio_(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        recordPhase(id_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - inicio_).count()));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    SeriesId id_;
+    std::chrono::steady_clock::time_point inicio_;
+};
+
+// Valor que se lee en cada scrape (conexiones, colas, cachés...)
+void gauge(const std::string& name, const std::string& help, std::function<double()> read);
+
+std::string renderPrometheus();
+
+}
+
+#endif // METRICS_H
@@ -0,0 +1,176 @@
+#include "response_compression.h"
+#include <zlib.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+template<typename T>
+void readEnv(const char* name, T& value) {
+    const char* v = std::getenv(name);
+    if (!v || !*v) return;
+    try {
+        value = static_cast<T>(std::stoull(v));
+    } catch (...) {
+        std::cerr << "Valor inválido para " << name << ": " << v << std::endl;
+    }
+}
+
+bool compressibleType(const std::string& contentType) {
+    std::string_view t = contentType;
+    t = t.substr(0, t.find(';'));
+    if (t == "text/event-stream") return false;
+    return t.rfind("text/", 0) == 0 || t == "application/json" ||
+           t == "application/javascript" || t == "application/xml" ||
+           t == "image/svg+xml";
+}
+
+std::string_view trim(std::string_view s) {
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.front()))) s.remove_prefix(1);
+    while (!s.empty() && std::isspace(static_cast<unsigned char>(s.back()))) s.remove_suffix(1);
+    return s;
+}
+
+bool equalsNoCase(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+bool gzip(const std::string& in, int level, std::string& out) {
+    z_stream z{};
+    if (deflateInit2(&z, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) return false;
+    out.resize(deflateBound(&z, static_cast<uLong>(in.size())) + 32);
+    z.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(in.data()));
+    z.avail_in = static_cast<uInt>(in.size());
+    z.next_out = reinterpret_cast<Bytef*>(out.data());
+    z.avail_out = static_cast<uInt>(out.size());
+    int rc = deflate(&z, Z_FINISH);
+    out.resize(z.total_out);
+    deflateEnd(&z);
+    return rc == Z_STREAM_END;
+}
+}
+
+CompressionConfig CompressionConfig::fromEnv() {
+    CompressionConfig cfg;
+    readEnv("HTTP_COMPRESSION", cfg.enabled);
+    readEnv("HTTP_COMPRESSION_MIN", cfg.minSize);
+    readEnv("HTTP_COMPRESSION_LEVEL", cfg.level);
+    readEnv("HTTP_COMPRESSION_CACHE", cfg.cacheBytes);
+    cfg.level = std::clamp(cfg.level, 1, 9);
+    return cfg;
+}
+
+ResponseCompressor::ResponseCompressor(const CompressionConfig& cfg) : cfg_(cfg) {
+    if (cfg_.enabled) {
+        std::cout << "HTTP: gzip desde " << cfg_.minSize << " bytes, nivel " << cfg_.level
+                  << ", caché " << cfg_.cacheBytes << " bytes" << std::endl;
+    }
+}
+
+void ResponseCompressor::install(httplib::Server& svr) {
+    if (!cfg_.enabled) return;
+    svr.set_post_routing_handler([this](const httplib::Request& req, httplib::Response& res) {
+        apply(req, res);
+    });
+}
+
+bool ResponseCompressor::acceptsGzip(std::string_view acceptEncoding) {
+    bool wildcard = false;
+    while (!acceptEncoding.empty()) {
+        size_t comma = acceptEncoding.find(',');
+        std::string_view item = acceptEncoding.substr(0, comma);
+        acceptEncoding = comma == std::string_view::npos ? std::string_view{} : acceptEncoding.substr(comma + 1);
+
+        size_t semi = item.find(';');
+        std::string_view coding = trim(item.substr(0, semi));
+        double q = 1.0;
+        if (semi != std::string_view::npos) {
+            std::string_view param = trim(item.substr(semi + 1));
+            if (param.size() > 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+                q = std::atof(std::string(param.substr(2)).c_str());
+            }
+        }
+        if (equalsNoCase(coding, "gzip") || equalsNoCase(coding, "x-gzip")) return q > 0;
+        if (coding == "*") wildcard = q > 0;
+    }
+    return wildcard;
+}
+
+void ResponseCompressor::apply(const httplib::Request& req, httplib::Response& res) {
+    if (res.body.size() < cfg_.minSize || res.has_header("Content-Encoding") ||
+        res.has_header("Content-Range") || !compressibleType(res.get_header_value("Content-Type"))) {
+        return;
+    }
+    // La respuesta depende de Accept-Encoding aunque esta vez no se comprima
+    res.set_header("Vary", "Accept-Encoding");
+    if (!acceptsGzip(req.get_header_value("Accept-Encoding"))) return;
+
+    bool cacheable = cfg_.cacheBytes > 0 && res.status == 200 &&
+                     (req.method == "GET" || req.method == "HEAD");
+    uint64_t key = cacheable ? std::hash<std::string>{}(res.body) : 0;
+
+    std::shared_ptr<const std::string> out = cacheable ? lookup(key, res.body) : nullptr;
+    if (out) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        auto fresh = std::make_shared<std::string>();
+        if (!gzip(res.body, cfg_.level, *fresh) || fresh->size() >= res.body.size()) return;
+        out = std::move(fresh);
+        if (cacheable) store(key, res.body, out);
+    }
+
+    compressed_.fetch_add(1, std::memory_order_relaxed);
+    bytesIn_.fetch_add(res.body.size(), std::memory_order_relaxed);
+    bytesOut_.fetch_add(out->size(), std::memory_order_relaxed);
+    res.body = *out;
+    res.set_header("Content-Encoding", "gzip");
+    // cpp-httplib ya fijó Content-Length con el tamaño sin comprimir
+    res.headers.erase("Content-Length");
+    res.set_header("Content-Length", std::to_string(res.body.size()));
+}
+
+std::shared_ptr<const std::string> ResponseCompressor::lookup(uint64_t key, const std::string& body) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cache_.find(key);
+    if (it == cache_.end() || it->second.body != body) return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+    return it->second.gzip;
+}
+
+void ResponseCompressor::store(uint64_t key, const std::string& body, std::shared_ptr<const std::string> gzip) {
+    size_t cost = body.size() + gzip->size();
+    if (cost > cfg_.cacheBytes) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+        cacheUsed_ -= it->second.body.size() + it->second.gzip->size();
+        lru_.erase(it->second.lru);
+        cache_.erase(it);
+    }
+    while (cacheUsed_ + cost > cfg_.cacheBytes && !lru_.empty()) {
+        auto victim = cache_.find(lru_.back());
+        cacheUsed_ -= victim->second.body.size() + victim->second.gzip->size();
+        cache_.erase(victim);
+        lru_.pop_back();
+    }
+    lru_.push_front(key);
+    cache_.emplace(key, Entry{body, std::move(gzip), lru_.begin()});
+    cacheUsed_ += cost;
+}
+
+ResponseCompressor::Stats ResponseCompressor::stats() const {
+    Stats s;
+    s.compressed = compressed_.load(std::memory_order_relaxed);
+    s.cacheHits = hits_.load(std::memory_order_relaxed);
+    s.bytesIn = bytesIn_.load(std::memory_order_relaxed);
+    s.bytesOut = bytesOut_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    s.cacheEntries = cache_.size();
+    s.cacheBytes = cacheUsed_;
+    return s;
+}
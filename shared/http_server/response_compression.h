@@ -0,0 +1,75 @@
+#ifndef RESPONSE_COMPRESSION_H
+#define RESPONSE_COMPRESSION_H
+
+#include "httplib.h"
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// --- CONFIGURACIÓN DE COMPRESIÓN ---
+// Cada campo se puede sobrescribir con una variable de entorno (ver fromEnv).
+struct CompressionConfig {
+    bool   enabled    = true;             // HTTP_COMPRESSION (0 la desactiva)
+    size_t minSize    = 1024;             // HTTP_COMPRESSION_MIN (bytes)
+    int    level      = 6;                // HTTP_COMPRESSION_LEVEL (1-9)
+    size_t cacheBytes = 16 * 1024 * 1024; // HTTP_COMPRESSION_CACHE (bytes, 0 = sin caché)
+
+    static CompressionConfig fromEnv();
+};
+
+// --- COMPRESIÓN NEGOCIADA DE RESPUESTAS ---
+// Comprime con gzip los cuerpos de tipo texto/JSON a partir de minSize si
+// el cliente lo acepta en Accept-Encoding (respetando q=0). Las respuestas
+// 200 a GET se guardan en una caché LRU indexada por el contenido, así un
+// listado que no cambia se comprime una sola vez. Se conecta como
+// post-routing handler; las respuestas en streaming no se tocan.
+class ResponseCompressor {
+public:
+    struct Stats {
+        size_t compressed = 0;    // respuestas comprimidas
+        size_t cacheHits = 0;
+        size_t cacheEntries = 0;
+        size_t cacheBytes = 0;
+        size_t bytesIn = 0;       // tamaño original de lo comprimido
+        size_t bytesOut = 0;
+    };
+
+    explicit ResponseCompressor(const CompressionConfig& cfg);
+
+    void install(httplib::Server& svr);
+    void apply(const httplib::Request& req, httplib::Response& res);
+
+    Stats stats() const;
+
+    // true si Accept-Encoding admite gzip con q > 0
+    static bool acceptsGzip(std::string_view acceptEncoding);
+
+private:
+    struct Entry {
+        std::string body;       // original, para descartar colisiones de hash
+        std::shared_ptr<const std::string> gzip;
+        std::list<uint64_t>::iterator lru;
+    };
+
+    std::shared_ptr<const std::string> lookup(uint64_t key, const std::string& body);
+    void store(uint64_t key, const std::string& body, std::shared_ptr<const std::string> gzip);
+
+    CompressionConfig cfg_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<uint64_t, Entry> cache_;
+    std::list<uint64_t> lru_;   // más reciente al frente
+    size_t cacheUsed_ = 0;
+
+    std::atomic<size_t> compressed_{0};
+    std::atomic<size_t> hits_{0};
+    std::atomic<size_t> bytesIn_{0};
+    std::atomic<size_t> bytesOut_{0};
+};
+
+#endif // RESPONSE_COMPRESSION_H
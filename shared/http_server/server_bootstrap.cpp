@@ -0,0 +1,286 @@
+#include "server_bootstrap.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+template<typename T>
+void readEnv(const char* name, T& value) {
+    const char* v = std::getenv(name);
+    if (!v || !*v) return;
+    try {
+        value = static_cast<T>(std::stoull(v));
+    } catch (...) {
+        std::cerr << "Valor inválido para " << name << ": " << v << std::endl;
+    }
+}
+
+size_t defaultThreads() {
+    // Mismo criterio que CPPHTTPLIB_THREAD_POOL_COUNT
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw > 1 ? std::max<size_t>(8, hw - 1) : 8;
+}
+
+size_t roundUpPow2(size_t n) {
+    size_t p = 2;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+// Colas vivas, para taskQueueStats()
+std::mutex queuesMutex;
+std::vector<const BoundedTaskQueue*> liveQueues;
+}
+
+ServerConfig ServerConfig::fromEnv() {
+    ServerConfig cfg;
+    readEnv("HTTP_THREADS", cfg.threads);
+    readEnv("HTTP_QUEUE_MAX", cfg.queueMax);
+    readEnv("HTTP_KEEPALIVE_MAX", cfg.keepAliveMaxCount);
+    readEnv("HTTP_KEEPALIVE_TIMEOUT", cfg.keepAliveTimeout);
+    readEnv("HTTP_READ_TIMEOUT", cfg.readTimeout);
+    readEnv("HTTP_WRITE_TIMEOUT", cfg.writeTimeout);
+    readEnv("HTTP_PAYLOAD_MAX", cfg.payloadMaxLength);
+    readEnv("HTTP_LISTENERS", cfg.listeners);
+    readEnv("HTTP_BACKLOG", cfg.backlog);
+    readEnv("HTTP_PIN_CORES", cfg.pinCores);
+    if (cfg.threads == 0) cfg.threads = defaultThreads();
+    if (cfg.queueMax == 0) cfg.queueMax = 1;
+    if (cfg.listeners == 0) cfg.listeners = 1;
+    if (cfg.backlog <= 0) cfg.backlog = 1024;
+#ifndef SO_REUSEPORT
+    if (cfg.listeners > 1) {
+        std::cerr << "SO_REUSEPORT no disponible; se usa un solo listener." << std::endl;
+        cfg.listeners = 1;
+    }
+#endif
+    return cfg;
+}
+
+BoundedTaskQueue::BoundedTaskQueue(size_t threads, size_t capacity)
+    : cells_(new Cell[roundUpPow2(capacity)]), mask_(roundUpPow2(capacity) - 1), threadCount_(threads) {
+    for (size_t i = 0; i <= mask_; ++i) {
+        cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> lock(queuesMutex);
+        liveQueues.push_back(this);
+    }
+    threads_.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        threads_.emplace_back([this] { worker(); });
+    }
+}
+
+BoundedTaskQueue::~BoundedTaskQueue() {
+    // cpp-httplib llama a shutdown() antes de destruir la cola; por si acaso
+    if (!threads_.empty()) shutdown();
+    std::lock_guard<std::mutex> lock(queuesMutex);
+    liveQueues.erase(std::remove(liveQueues.begin(), liveQueues.end(), this), liveQueues.end());
+}
+
+bool BoundedTaskQueue::tryPush(std::function<void()>& fn) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells_[pos & mask_];
+        size_t seq = cell.seq.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+        if (diff == 0) {
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                cell.fn = std::move(fn);
+                cell.seq.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // llena
+        } else {
+            pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool BoundedTaskQueue::tryPop(std::function<void()>& fn) {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    for (;;) {
+        Cell& cell = cells_[pos & mask_];
+        size_t seq = cell.seq.load(std::memory_order_acquire);
+        auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos + 1);
+        if (diff == 0) {
+            if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                fn = std::move(cell.fn);
+                cell.fn = nullptr;
+                cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false; // vacía
+        } else {
+            pos = head_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+bool BoundedTaskQueue::enqueue(std::function<void()> fn) {
+    // Se cuenta antes de publicar la celda: un worker que la saque enseguida
+    // nunca deja pending_ por debajo de cero (size_t daría la vuelta y los
+    // workers ociosos girarían sin esperar).
+    pending_.fetch_add(1, std::memory_order_release);
+    if (!tryPush(fn)) {
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    {
+        // Tomar el mutex evita perder el aviso entre la comprobación y el wait
+        std::lock_guard<std::mutex> lock(mutex_);
+    }
+    cond_.notify_one();
+    return true;
+}
+
+void BoundedTaskQueue::worker() {
+    for (;;) {
+        std::function<void()> fn;
+        if (tryPop(fn)) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            busy_.fetch_add(1, std::memory_order_relaxed);
+            fn();
+            busy_.fetch_sub(1, std::memory_order_relaxed);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [&] {
+            return shutdown_ || pending_.load(std::memory_order_acquire) > 0;
+        });
+        if (shutdown_ && pending_.load(std::memory_order_acquire) == 0) break;
+    }
+}
+
+void BoundedTaskQueue::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shutdown_ = true;
+    }
+    cond_.notify_all();
+    for (auto& t : threads_) t.join();
+    threads_.clear();
+}
+
+TaskQueueStats taskQueueStats() {
+    TaskQueueStats stats;
+    std::lock_guard<std::mutex> lock(queuesMutex);
+    for (const auto* q : liveQueues) {
+        stats.threads += q->threads();
+        stats.busy += q->busy();
+        stats.pending += q->pending();
+        stats.rejected += q->rejected();
+    }
+    return stats;
+}
+
+void applyServerConfig(httplib::Server& svr, const ServerConfig& cfg) {
+    svr.new_task_queue = [cfg] { return new BoundedTaskQueue(cfg.threads, cfg.queueMax); };
+    svr.set_keep_alive_max_count(cfg.keepAliveMaxCount);
+    svr.set_keep_alive_timeout(cfg.keepAliveTimeout);
+    svr.set_read_timeout(cfg.readTimeout, 0);
+    svr.set_write_timeout(cfg.writeTimeout, 0);
+    svr.set_payload_max_length(cfg.payloadMaxLength);
+
+#ifdef _WIN32
+    const int backlog = CPPHTTPLIB_LISTEN_BACKLOG; // Winsock no lo cambia tras listen()
+#else
+    const int backlog = cfg.backlog;
+#endif
+    std::cout << "HTTP: " << cfg.threads << " hilos, cola " << cfg.queueMax
+              << ", backlog " << backlog
+              << ", keep-alive " << cfg.keepAliveMaxCount << "/" << cfg.keepAliveTimeout << "s"
+              << ", timeouts " << cfg.readTimeout << "s/" << cfg.writeTimeout << "s"
+              << ", payload " << cfg.payloadMaxLength << " bytes" << std::endl;
+}
+
+ListenerGroup::ListenerGroup(const ServerConfig& cfg, Factory factory) : cfg_(cfg) {
+    if (!factory) {
+        factory = [](const ServerConfig& c) {
+            auto svr = std::make_unique<httplib::Server>();
+            applyServerConfig(*svr, c);
+            return svr;
+        };
+    }
+    // Los hilos configurados se reparten entre las instancias
+    ServerConfig each = cfg;
+    each.threads = std::max<size_t>(1, cfg.threads / cfg.listeners);
+    each.queueMax = std::max<size_t>(1, cfg.queueMax / cfg.listeners);
+    for (size_t i = 0; i < cfg.listeners; ++i) servers_.push_back(factory(each));
+    if (cfg.listeners > 1) {
+        std::cout << "HTTP: " << cfg.listeners << " listeners con SO_REUSEPORT" << std::endl;
+    }
+}
+
+void ListenerGroup::each(const std::function<void(httplib::Server&)>& fn) {
+    for (auto& svr : servers_) fn(*svr);
+}
+
+bool ListenerGroup::listen(const std::string& host, int port) {
+    std::vector<socket_t> sockets(servers_.size(), INVALID_SOCKET);
+    for (size_t i = 0; i < servers_.size(); ++i) {
+        socket_t* slot = &sockets[i];
+        servers_[i]->set_socket_options([slot](socket_t sock) {
+            httplib::detail::set_socket_opt(sock, SOL_SOCKET, SO_REUSEADDR, 1);
+#ifdef SO_REUSEPORT
+            httplib::detail::set_socket_opt(sock, SOL_SOCKET, SO_REUSEPORT, 1);
+#endif
+            *slot = sock;
+        });
+        if (!servers_[i]->bind_to_port(host, port)) {
+            std::cerr << "No se pudo abrir " << host << ":" << port << std::endl;
+            stop();
+            return false;
+        }
+        // cpp-httplib escucha con CPPHTTPLIB_LISTEN_BACKLOG (fijado en
+        // CMakeLists). En POSIX, volver a llamar a listen() sobre el socket ya
+        // en escucha solo cambia el tamaño de la cola (hasta somaxconn);
+        // Winsock ignora la segunda llamada.
+        if (cfg_.backlog != CPPHTTPLIB_LISTEN_BACKLOG) {
+#ifdef _WIN32
+            if (i == 0) {
+                std::cerr << "HTTP_BACKLOG no tiene efecto en Windows; se usa "
+                          << CPPHTTPLIB_LISTEN_BACKLOG << " (CPPHTTPLIB_LISTEN_BACKLOG)" << std::endl;
+            }
+#else
+            if (::listen(sockets[i], cfg_.backlog) != 0) {
+                std::cerr << "No se pudo cambiar el backlog a " << cfg_.backlog << ": "
+                          << std::strerror(errno) << "; se mantiene " << CPPHTTPLIB_LISTEN_BACKLOG << std::endl;
+            }
+#endif
+        }
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < servers_.size(); ++i) {
+        threads.emplace_back([this, i] {
+#ifdef __linux__
+            if (cfg_.pinCores) {
+                unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(i % cores, &set);
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            }
+#endif
+            servers_[i]->listen_after_bind();
+        });
+    }
+    for (auto& t : threads) t.join();
+    return true;
+}
+
+void ListenerGroup::stop() {
+    for (auto& svr : servers_) svr->stop();
+}
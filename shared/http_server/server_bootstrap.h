@@ -0,0 +1,113 @@
+#ifndef SERVER_BOOTSTRAP_H
+#define SERVER_BOOTSTRAP_H
+
+#include "httplib.h"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// --- CONFIGURACIÓN DEL SERVIDOR HTTP ---
+// Valores por defecto iguales a los de cpp-httplib salvo la cola y el
+// tamaño de payload, que allí no tienen límite. Cada campo se puede
+// sobrescribir con una variable de entorno (ver fromEnv).
+struct ServerConfig {
+    size_t threads           = 0;         // HTTP_THREADS (0 = según núcleos)
+    size_t queueMax          = 1024;      // HTTP_QUEUE_MAX
+    size_t keepAliveMaxCount = 100;       // HTTP_KEEPALIVE_MAX
+    time_t keepAliveTimeout  = 5;         // HTTP_KEEPALIVE_TIMEOUT (s)
+    time_t readTimeout       = 5;         // HTTP_READ_TIMEOUT (s)
+    time_t writeTimeout      = 5;         // HTTP_WRITE_TIMEOUT (s)
+    size_t payloadMaxLength  = 2 * 1024 * 1024; // HTTP_PAYLOAD_MAX (bytes)
+    size_t listeners         = 1;         // HTTP_LISTENERS (SO_REUSEPORT)
+    int    backlog           = 1024;      // HTTP_BACKLOG (en Windows, CPPHTTPLIB_LISTEN_BACKLOG)
+    bool   pinCores          = false;     // HTTP_PIN_CORES (solo Linux)
+
+    static ServerConfig fromEnv();
+};
+
+// --- COLA DE TAREAS ACOTADA ---
+// Cola MPMC de capacidad fija (anillo con números de secuencia por celda).
+// El hilo que acepta conexiones nunca se bloquea: si la cola está llena,
+// enqueue devuelve false y cpp-httplib cierra el socket (descarte de carga).
+class BoundedTaskQueue final : public httplib::TaskQueue {
+public:
+    BoundedTaskQueue(size_t threads, size_t capacity);
+    ~BoundedTaskQueue() override;
+
+    bool enqueue(std::function<void()> fn) override;
+    void shutdown() override;
+
+    size_t rejected() const { return rejected_.load(std::memory_order_relaxed); }
+    size_t pending() const { return pending_.load(std::memory_order_relaxed); }
+    size_t busy() const { return busy_.load(std::memory_order_relaxed); }
+    size_t threads() const { return threadCount_; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        std::function<void()> fn;
+    };
+
+    bool tryPush(std::function<void()>& fn);
+    bool tryPop(std::function<void()>& fn);
+    void worker();
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) std::atomic<size_t> pending_{0};
+    std::atomic<size_t> rejected_{0};
+    std::atomic<size_t> busy_{0};
+    size_t threadCount_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool shutdown_ = false;
+    std::vector<std::thread> threads_;
+};
+
+// Suma de todas las colas vivas (todas las instancias del grupo)
+struct TaskQueueStats {
+    size_t threads = 0;
+    size_t busy = 0;     // hilos ejecutando una conexión
+    size_t pending = 0;  // conexiones esperando hilo
+    size_t rejected = 0; // descartadas por cola llena
+};
+TaskQueueStats taskQueueStats();
+
+// Aplica la configuración al servidor e instala la cola acotada.
+void applyServerConfig(httplib::Server& svr, const ServerConfig& cfg);
+
+// --- GRUPO DE LISTENERS ---
+// N instancias de httplib::Server escuchando en el mismo puerto con
+// SO_REUSEPORT: el kernel reparte las conexiones entre N colas de accept,
+// cada una con su propio bucle de aceptación y su propio pool (los hilos se
+// reparten entre instancias). Con pinCores, el hilo de cada listener se fija
+// a un núcleo y sus workers heredan esa afinidad. Las rutas se registran
+// en cada instancia con each().
+class ListenerGroup {
+public:
+    using Factory = std::function<std::unique_ptr<httplib::Server>(const ServerConfig&)>;
+
+    // Sin factory se crean httplib::Server con applyServerConfig
+    explicit ListenerGroup(const ServerConfig& cfg, Factory factory = {});
+
+    void each(const std::function<void(httplib::Server&)>& fn);
+    // Bloquea hasta que se detienen todas las instancias
+    bool listen(const std::string& host, int port);
+    void stop();
+
+    size_t size() const { return servers_.size(); }
+
+private:
+    ServerConfig cfg_;
+    std::vector<std::unique_ptr<httplib::Server>> servers_;
+};
+
+#endif // SERVER_BOOTSTRAP_H
@@ -0,0 +1,222 @@
+#include "trie_router.h"
+#include "metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+enum Method { GET, POST, PUT, PATCH, DELETE_, METHOD_COUNT };
+
+int methodIndex(const std::string& m) {
+    if (m == "GET" || m == "HEAD") return GET;
+    if (m == "POST") return POST;
+    if (m == "PUT") return PUT;
+    if (m == "PATCH") return PATCH;
+    if (m == "DELETE") return DELETE_;
+    return -1;
+}
+
+// Entero decimal sin signo que cabe en int64_t
+bool parseInt(std::string_view s, int64_t& out) {
+    if (s.empty() || s.size() > 18) return false;
+    int64_t v = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + (c - '0');
+    }
+    out = v;
+    return true;
+}
+
+bool hasBody(const httplib::Request& req) {
+    if (req.has_header("Content-Length") && req.get_header_value_u64("Content-Length") > 0) return true;
+    return httplib::detail::is_chunked_transfer_encoding(req.headers);
+}
+
+// Ruta resuelta en el pre-routing, pendiente de que se lea el cuerpo.
+// Pre-routing y handler corren en el mismo hilo para una misma petición.
+struct Pending {
+    const httplib::Request* req = nullptr;
+    const TrieRouter::Handler* handler = nullptr;
+    RouteParams params;
+};
+thread_local Pending pending;
+}
+
+struct TrieRouter::Node {
+    // Aristas estáticas: uno o más segmentos completos ("api/marathons")
+    std::vector<std::pair<std::string, std::unique_ptr<Node>>> children;
+    std::unique_ptr<Node> intChild;
+    std::unique_ptr<Node> strChild;
+    std::array<Handler, METHOD_COUNT> handlers;
+
+    bool hasHandlers() const {
+        return std::any_of(handlers.begin(), handlers.end(), [](const Handler& h) { return bool(h); });
+    }
+};
+
+TrieRouter::TrieRouter() : root(std::make_unique<Node>()) {}
+TrieRouter::~TrieRouter() = default;
+
+TrieRouter& TrieRouter::add(const std::string& method, const std::string& pattern, Handler handler) {
+    int m = methodIndex(method);
+    if (m < 0 || method == "HEAD") throw std::invalid_argument("Método no soportado: " + method);
+    if (compacted) throw std::logic_error("No se pueden añadir rutas después de install()");
+
+    Node* node = root.get();
+    size_t ints = 0, strs = 0;
+    size_t pos = pattern.empty() || pattern[0] != '/' ? 0 : 1;
+    while (pos < pattern.size()) {
+        size_t fin = pattern.find('/', pos);
+        if (fin == std::string::npos) fin = pattern.size();
+        std::string segmento = pattern.substr(pos, fin - pos);
+        pos = fin + 1;
+
+        if (segmento == "{int}" || segmento == "{str}") {
+            bool entero = segmento == "{int}";
+            if ((entero ? ++ints : ++strs) > RouteParams::MAX) {
+                throw std::invalid_argument("Demasiados parámetros en " + pattern);
+            }
+            auto& hijo = entero ? node->intChild : node->strChild;
+            if (!hijo) hijo = std::make_unique<Node>();
+            node = hijo.get();
+            continue;
+        }
+        auto it = std::find_if(node->children.begin(), node->children.end(),
+                               [&](const auto& c) { return c.first == segmento; });
+        if (it == node->children.end()) {
+            node->children.emplace_back(segmento, std::make_unique<Node>());
+            it = node->children.end() - 1;
+        }
+        node = it->second.get();
+    }
+    node->handlers[m] = timed(metrics::route(method, pattern), std::move(handler));
+    return *this;
+}
+
+// Cuenta la petición y su latencia en la serie de la ruta. Un status sin
+// asignar (-1) lo convierte cpp-httplib en 200; una excepción, en 500.
+TrieRouter::Handler TrieRouter::timed(uint16_t series, Handler handler) {
+    return [series, h = std::move(handler)](const httplib::Request& req, httplib::Response& res,
+                                            const RouteParams& params) {
+        auto inicio = std::chrono::steady_clock::now();
+        auto transcurrido = [&] {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - inicio).count());
+        };
+        try {
+            h(req, res, params);
+        } catch (...) {
+            metrics::recordRequest(series, 500, transcurrido());
+            throw;
+        }
+        metrics::recordRequest(series, res.status == -1 ? 200 : res.status, transcurrido());
+    };
+}
+
+// Une cadenas de segmentos estáticos sin bifurcaciones en una sola arista
+void TrieRouter::compress(Node* node) {
+    for (auto& [etiqueta, hijo] : node->children) {
+        while (hijo->children.size() == 1 && !hijo->intChild && !hijo->strChild && !hijo->hasHandlers()) {
+            auto& nieto = hijo->children.front();
+            etiqueta += '/';
+            etiqueta += nieto.first;
+            std::unique_ptr<Node> siguiente = std::move(nieto.second);
+            hijo = std::move(siguiente);
+        }
+        compress(hijo.get());
+    }
+    if (node->intChild) compress(node->intChild.get());
+    if (node->strChild) compress(node->strChild.get());
+}
+
+namespace {
+// Recorrido con retroceso: si una arista estática coincide pero el resto no,
+// se prueban {int} y {str} en el mismo nivel.
+template<typename NodeT>
+const TrieRouter::Handler* matchNode(const NodeT* node, std::string_view path, size_t pos,
+                                     int m, RouteParams& params) {
+    if (pos >= path.size()) {
+        const auto& h = node->handlers[m];
+        return h ? &h : nullptr;
+    }
+    std::string_view resto = path.substr(pos);
+    size_t fin = resto.find('/');
+    std::string_view segmento = resto.substr(0, fin);
+    size_t siguiente = fin == std::string_view::npos ? path.size() : pos + fin + 1;
+
+    for (const auto& [etiqueta, hijo] : node->children) {
+        // La etiqueta debe terminar justo en un '/' o en el final del path
+        if (resto.size() < etiqueta.size() || std::memcmp(resto.data(), etiqueta.data(), etiqueta.size()) != 0) continue;
+        if (resto.size() > etiqueta.size() && resto[etiqueta.size()] != '/') continue;
+        size_t despues = pos + etiqueta.size() + (resto.size() > etiqueta.size() ? 1 : 0);
+        if (auto h = matchNode(hijo.get(), path, despues, m, params)) return h;
+    }
+    if (node->intChild && params.intCount < RouteParams::MAX) {
+        int64_t v;
+        if (parseInt(segmento, v)) {
+            params.ints[params.intCount++] = v;
+            if (auto h = matchNode(node->intChild.get(), path, siguiente, m, params)) return h;
+            --params.intCount;
+        }
+    }
+    if (node->strChild && !segmento.empty() && params.strCount < RouteParams::MAX) {
+        params.strs[params.strCount++] = segmento;
+        if (auto h = matchNode(node->strChild.get(), path, siguiente, m, params)) return h;
+        --params.strCount;
+    }
+    return nullptr;
+}
+}
+
+const TrieRouter::Handler* TrieRouter::match(const std::string& method, std::string_view path,
+                                             RouteParams& params) const {
+    int m = methodIndex(method);
+    if (m < 0) return nullptr;
+    params = RouteParams{};
+    size_t pos = !path.empty() && path[0] == '/' ? 1 : 0;
+    // Una barra final no cambia la ruta ("/api/health/")
+    if (path.size() > 1 && path.back() == '/') path.remove_suffix(1);
+    return matchNode(root.get(), path, pos, m, params);
+}
+
+void TrieRouter::install(httplib::Server& svr,
+                         std::function<void(const httplib::Request&, httplib::Response&)> antes) {
+    if (!compacted) {
+        compress(root.get());
+        compacted = true;
+    }
+
+    svr.set_pre_routing_handler([this, antes](const httplib::Request& req, httplib::Response& res) {
+        if (antes) antes(req, res);
+        pending = Pending{};
+        RouteParams params;
+        const Handler* h = match(req.method, req.path, params);
+        if (!h) return httplib::Server::HandlerResponse::Unhandled;
+        if (hasBody(req)) {
+            // Se atiende en el handler comodín, con el cuerpo ya leído
+            pending = Pending{&req, h, params};
+            return httplib::Server::HandlerResponse::Unhandled;
+        }
+        (*h)(req, res, params);
+        return httplib::Server::HandlerResponse::Handled;
+    });
+
+    auto comodin = [](const httplib::Request& req, httplib::Response& res) {
+        if (pending.req != &req || !pending.handler) {
+            res.status = 404;
+            return;
+        }
+        Pending p = pending;
+        pending = Pending{};
+        (*p.handler)(req, res, p.params);
+    };
+    // Un único patrón por método para las peticiones con cuerpo (cpp-httplib
+    // lee el cuerpo después del pre-routing y no expone otro punto de enganche)
+    svr.Get(".*", comodin);
+    svr.Post(".*", comodin);
+    svr.Put(".*", comodin);
+    svr.Patch(".*", comodin);
+    svr.Delete(".*", comodin);
+}
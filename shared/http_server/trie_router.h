@@ -0,0 +1,92 @@
+#ifndef TRIE_ROUTER_H
+#define TRIE_ROUTER_H
+
+#include "httplib.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// --- PARÁMETROS DE RUTA ---
+// Capturas tipadas en el orden del patrón: {int} se guarda ya convertido a
+// entero y {str} como vista sobre req.path (válida durante la petición).
+struct RouteParams {
+    static constexpr size_t MAX = 4;
+
+    std::array<int64_t, MAX> ints{};
+    std::array<std::string_view, MAX> strs{};
+    size_t intCount = 0;
+    size_t strCount = 0;
+
+    int64_t integer(size_t i) const { return ints[i]; }
+    // Entero como texto, para pasarlo como parámetro de libpq
+    std::string text(size_t i) const { return std::to_string(ints[i]); }
+    std::string str(size_t i) const { return std::string(strs[i]); }
+};
+
+// --- ENRUTADOR CON TRIE RADIX ---
+// Sustituye el recorrido lineal de cpp-httplib (un std::regex_match por
+// ruta registrada) por un trie de segmentos con aristas estáticas
+// comprimidas. Patrones: "/api/marathons/{int}/problems/{int}", "/optimize/{str}".
+// Prioridad por segmento: estático, luego {int}, luego {str}.
+//
+// Se engancha con install(): el pre-routing resuelve la ruta en O(largo del
+// path). Las peticiones sin cuerpo se atienden ahí mismo; las que tienen
+// cuerpo se atienden desde un único handler comodín por método, después de
+// que cpp-httplib lea el cuerpo. Cada ruta registrada tiene su serie en
+// metrics: peticiones por clase de estado y latencia del handler.
+class TrieRouter {
+public:
+    using Handler = std::function<void(const httplib::Request&, httplib::Response&, const RouteParams&)>;
+
+    TrieRouter();
+    ~TrieRouter();
+
+    TrieRouter(const TrieRouter&) = delete;
+    TrieRouter& operator=(const TrieRouter&) = delete;
+
+    // Acepta handlers (req, res) o (req, res, params)
+    template<typename F> TrieRouter& Get(const std::string& p, F&& f)    { return add("GET", p, wrap(std::forward<F>(f))); }
+    template<typename F> TrieRouter& Post(const std::string& p, F&& f)   { return add("POST", p, wrap(std::forward<F>(f))); }
+    template<typename F> TrieRouter& Put(const std::string& p, F&& f)    { return add("PUT", p, wrap(std::forward<F>(f))); }
+    template<typename F> TrieRouter& Patch(const std::string& p, F&& f)  { return add("PATCH", p, wrap(std::forward<F>(f))); }
+    template<typename F> TrieRouter& Delete(const std::string& p, F&& f) { return add("DELETE", p, wrap(std::forward<F>(f))); }
+
+    TrieRouter& add(const std::string& method, const std::string& pattern, Handler handler);
+
+    // Busca la ruta; nullptr si no hay. HEAD usa el handler de GET.
+    const Handler* match(const std::string& method, std::string_view path, RouteParams& params) const;
+
+    // Conecta el enrutador al servidor. `antes` corre en el pre-routing para
+    // todas las peticiones (p. ej. cabeceras CORS). Las rutas no registradas
+    // siguen el camino normal de cpp-httplib.
+    void install(httplib::Server& svr,
+                 std::function<void(const httplib::Request&, httplib::Response&)> antes = {});
+
+private:
+    struct Node;
+
+    template<typename F>
+    static Handler wrap(F&& f) {
+        if constexpr (std::is_invocable_v<F&, const httplib::Request&, httplib::Response&, const RouteParams&>) {
+            return Handler(std::forward<F>(f));
+        } else {
+            return [g = std::forward<F>(f)](const httplib::Request& req, httplib::Response& res,
+                                            const RouteParams&) mutable { g(req, res); };
+        }
+    }
+
+    // Envuelve el handler para registrar peticiones y latencia (ver metrics.h)
+    static Handler timed(uint16_t series, Handler handler);
+    void compress(Node* node);
+
+    std::unique_ptr<Node> root;
+    bool compacted = false;
+};
+
+#endif // TRIE_ROUTER_H